@@ -3,16 +3,24 @@
 #include <shlobj.h>
 #include <commctrl.h>
 #include <winsvc.h>
+#include <psapi.h>
 #include <string>
 #include <vector>
 #include <thread>
 #include <mutex>
+#include <condition_variable>
 #include <atomic>
 #include <filesystem>
 #include <fstream>
-#include <regex>
 #include <chrono>
 #include <map>
+#include <memory>
+#include <memory_resource>
+#include <functional>
+#include <exception>
+#include <random>
+#include <string_view>
+#include <set>
 #include <algorithm>
 #include "resource.h"
 
@@ -27,30 +35,2293 @@
 #define ID_TRAY_PAUSE 1003
 #define ID_TRAY_SETTINGS 1004
 #define MAX_PASSWORD_ATTEMPTS 3
+#define DISK_IMAGE_SECTOR_SIZE 2048
+#define MAX_IMAGE_COPY_THREADS 4
+#define MAX_DIRECTORY_DEPTH 64
+#define JOB_ARENA_SIZE 8192
+#define MAX_RETRY_DELAY_MS (6 * 60 * 60 * 1000)
+
+// Read-only memory mapping of a whole file
+class MappedFile {
+public:
+    MappedFile() = default;
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    ~MappedFile() {
+        Close();
+    }
+
+    bool Open(const std::string& path) {
+        hFile = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ,
+                            NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+        if (hFile == INVALID_HANDLE_VALUE) {
+            return false;
+        }
+
+        LARGE_INTEGER fileSize;
+        if (!GetFileSizeEx(hFile, &fileSize) || fileSize.QuadPart == 0) {
+            Close();
+            return false;
+        }
+
+        hMapping = CreateFileMappingA(hFile, NULL, PAGE_READONLY, 0, 0, NULL);
+        if (hMapping) {
+            view = (const uint8_t*)MapViewOfFile(hMapping, FILE_MAP_READ, 0, 0, 0);
+        }
+        if (!view) {
+            Close();
+            return false;
+        }
+
+        size = (uint64_t)fileSize.QuadPart;
+        return true;
+    }
+
+    void Close() {
+        if (view) UnmapViewOfFile(view);
+        if (hMapping) CloseHandle(hMapping);
+        if (hFile != INVALID_HANDLE_VALUE) CloseHandle(hFile);
+        view = nullptr;
+        hMapping = NULL;
+        hFile = INVALID_HANDLE_VALUE;
+        size = 0;
+    }
+
+    const uint8_t* Data() const { return view; }
+    uint64_t Size() const { return size; }
+
+private:
+    HANDLE hFile = INVALID_HANDLE_VALUE;
+    HANDLE hMapping = NULL;
+    const uint8_t* view = nullptr;
+    uint64_t size = 0;
+};
+
+// Native ISO9660 (Joliet / Rock Ridge) and UDF reader. Disk images are not compressed,
+// so the image is memory-mapped and every file extent is written straight from the view.
+class DiskImageReader {
+public:
+    struct Extent {
+        uint64_t offset = 0;   // Byte offset into the image
+        uint64_t length = 0;
+        bool sparse = false;   // Unrecorded UDF extent, reads as zeros
+    };
+
+    struct Entry {
+        std::wstring path;     // Relative to the image root, backslash separated
+        bool isDirectory = false;
+        uint64_t size = 0;
+        std::vector<Extent> extents;
+    };
+
+    DiskImageReader() = default;
+    DiskImageReader(const DiskImageReader&) = delete;
+    DiskImageReader& operator=(const DiskImageReader&) = delete;
+
+    ~DiskImageReader() {
+        Close();
+    }
+
+    bool Open(const std::string& imagePath) {
+        if (!image.Open(imagePath) || image.Size() < 17 * DISK_IMAGE_SECTOR_SIZE) {
+            Close();
+            return false;
+        }
+
+        view = image.Data();
+        imageSize = image.Size();
+        return true;
+    }
+
+    void Close() {
+        image.Close();
+        view = nullptr;
+        imageSize = 0;
+    }
+
+    // Prefer UDF when the image carries an NSR descriptor (DVD/Blu-ray bridge discs
+    // often have truncated ISO9660 names), otherwise walk the ISO9660 tree. A UDF volume
+    // this reader cannot follow (virtual or metadata partitions) fails here rather than
+    // falling back to the bridge disc's ISO9660 view, which may only hold placeholders.
+    bool Parse() {
+        entries.clear();
+        if (HasUdfRecognitionSequence()) {
+            if (!ParseUdf()) {
+                entries.clear();
+                return false;
+            }
+            formatName = "UDF";
+            return true;
+        }
+
+        entries.clear();
+        visitedDirectories.clear();
+        return ParseIso9660();
+    }
+
+    const std::vector<Entry>& Entries() const { return entries; }
+    const char* FormatName() const { return formatName; }
+
+    uint64_t TotalFileBytes() const {
+        uint64_t total = 0;
+        for (const auto& entry : entries) {
+            total += entry.size;
+        }
+        return total;
+    }
+
+    // Creates the directory tree, then copies files on a small thread pool
+    bool ExtractTo(const std::filesystem::path& outputDir, std::string& error) const {
+        std::error_code ec;
+        std::filesystem::create_directories(outputDir, ec);
+        if (ec) {
+            error = "Cannot create output directory: " + ec.message();
+            return false;
+        }
+
+        std::vector<size_t> files;
+        for (size_t i = 0; i < entries.size(); i++) {
+            if (entries[i].isDirectory) {
+                std::filesystem::create_directories(outputDir / entries[i].path, ec);
+                if (ec) {
+                    error = "Cannot create directory " + WideToUtf8(entries[i].path) + ": " + ec.message();
+                    return false;
+                }
+            } else {
+                files.push_back(i);
+            }
+        }
+
+        // Largest files first so a single big file does not end up alone at the tail
+        std::sort(files.begin(), files.end(), [this](size_t a, size_t b) {
+            return entries[a].size > entries[b].size;
+        });
+
+        size_t workerCount = std::min<size_t>(files.size(),
+            std::clamp<size_t>(std::thread::hardware_concurrency(), 1, MAX_IMAGE_COPY_THREADS));
+
+        std::atomic<size_t> nextFile{0};
+        std::atomic<bool> failed{false};
+        std::mutex errorMutex;
+
+        auto worker = [&]() {
+            while (!failed) {
+                size_t index = nextFile++;
+                if (index >= files.size()) break;
+
+                std::string fileError;
+                if (!WriteEntry(entries[files[index]], outputDir, fileError)) {
+                    std::lock_guard<std::mutex> lock(errorMutex);
+                    if (!failed.exchange(true)) {
+                        error = fileError;
+                    }
+                }
+            }
+        };
+
+        std::vector<std::thread> workers;
+        for (size_t i = 0; i < workerCount; i++) {
+            workers.emplace_back(worker);
+        }
+        for (auto& thread : workers) {
+            thread.join();
+        }
+
+        return !failed;
+    }
+
+private:
+    enum class IsoNaming { Plain, Joliet, RockRidge };
+
+    struct UdfNode {
+        bool isDirectory = false;
+        uint64_t size = 0;
+        std::vector<Extent> extents;
+    };
+
+    MappedFile image;
+    const uint8_t* view = nullptr;
+    uint64_t imageSize = 0;
+    const char* formatName = "";
+    std::vector<Entry> entries;
+    std::set<uint64_t> visitedDirectories;
+
+    // ISO9660 state
+    IsoNaming isoNaming = IsoNaming::Plain;
+    size_t suspSkip = 0;
+
+    // UDF state: partition reference number -> first sector of the partition
+    std::vector<uint32_t> udfPartitionStart;
+
+    static uint16_t ReadLe16(const uint8_t* p) {
+        return (uint16_t)(p[0] | (p[1] << 8));
+    }
+
+    static uint32_t ReadLe32(const uint8_t* p) {
+        return (uint32_t)p[0] | ((uint32_t)p[1] << 8) | ((uint32_t)p[2] << 16) | ((uint32_t)p[3] << 24);
+    }
+
+    static uint64_t ReadLe64(const uint8_t* p) {
+        return (uint64_t)ReadLe32(p) | ((uint64_t)ReadLe32(p + 4) << 32);
+    }
+
+    bool InRange(uint64_t offset, uint64_t length) const {
+        return offset <= imageSize && length <= imageSize - offset;
+    }
+
+    static std::string WideToUtf8(const std::wstring& wstr) {
+        if (wstr.empty()) return std::string();
+        int size = WideCharToMultiByte(CP_UTF8, 0, wstr.data(), (int)wstr.size(), NULL, 0, NULL, NULL);
+        std::string result(size, 0);
+        WideCharToMultiByte(CP_UTF8, 0, wstr.data(), (int)wstr.size(), &result[0], size, NULL, NULL);
+        return result;
+    }
+
+    static std::wstring Utf8ToWide(const char* str, size_t length) {
+        if (length == 0) return std::wstring();
+        int size = MultiByteToWideChar(CP_UTF8, 0, str, (int)length, NULL, 0);
+        std::wstring result(size, 0);
+        MultiByteToWideChar(CP_UTF8, 0, str, (int)length, &result[0], size);
+        return result;
+    }
+
+    // Rejects names that would escape the output directory and replaces characters
+    // Windows does not allow in file names (Rock Ridge names are POSIX names)
+    static bool SanitizeName(std::wstring& name) {
+        if (name.empty() || name == L"." || name == L"..") {
+            return false;
+        }
+        for (auto& ch : name) {
+            if (ch < 0x20 || wcschr(L"<>:\"/\\|?*", ch)) {
+                ch = L'_';
+            }
+        }
+        return true;
+    }
+
+    bool WriteEntry(const Entry& entry, const std::filesystem::path& outputDir, std::string& error) const {
+        std::filesystem::path target = outputDir / entry.path;
+        HANDLE hOut = CreateFileW(target.wstring().c_str(), GENERIC_WRITE, 0, NULL, CREATE_ALWAYS,
+                                  FILE_ATTRIBUTE_NORMAL | FILE_FLAG_SEQUENTIAL_SCAN, NULL);
+        if (hOut == INVALID_HANDLE_VALUE) {
+            error = "Cannot create " + WideToUtf8(entry.path);
+            return false;
+        }
+
+        // Reserve the final size up front to keep the destination unfragmented;
+        // this also leaves sparse extents zero-filled
+        LARGE_INTEGER position;
+        position.QuadPart = (long long)entry.size;
+        bool ok = SetFilePointerEx(hOut, position, NULL, FILE_BEGIN) && SetEndOfFile(hOut);
+        position.QuadPart = 0;
+        ok = ok && SetFilePointerEx(hOut, position, NULL, FILE_BEGIN);
+
+        for (const auto& extent : entry.extents) {
+            if (!ok) break;
+
+            if (extent.sparse) {
+                position.QuadPart = (long long)extent.length;
+                ok = SetFilePointerEx(hOut, position, NULL, FILE_CURRENT);
+                continue;
+            }
+
+            // The mapped view is handed to WriteFile directly; no intermediate buffer
+            const uint8_t* source = view + extent.offset;
+            uint64_t remaining = extent.length;
+            while (ok && remaining > 0) {
+                DWORD chunk = (DWORD)std::min<uint64_t>(remaining, 64ull * 1024 * 1024);
+                DWORD written = 0;
+                ok = WriteFile(hOut, source, chunk, &written, NULL) && written == chunk;
+                source += chunk;
+                remaining -= chunk;
+            }
+        }
+
+        CloseHandle(hOut);
+
+        if (!ok) {
+            error = "Write failed for " + WideToUtf8(entry.path) + " (error " + std::to_string(GetLastError()) + ")";
+        }
+        return ok;
+    }
+
+    // ---- ISO9660 ----
+
+    bool ParseIso9660() {
+        const uint8_t* primaryRoot = nullptr;
+        const uint8_t* jolietRoot = nullptr;
+
+        for (uint64_t sector = 16; ; sector++) {
+            uint64_t offset = sector * DISK_IMAGE_SECTOR_SIZE;
+            if (!InRange(offset, DISK_IMAGE_SECTOR_SIZE)) break;
+
+            const uint8_t* descriptor = view + offset;
+            if (memcmp(descriptor + 1, "CD001", 5) != 0) break;
+
+            if (descriptor[0] == 1 && !primaryRoot) {
+                primaryRoot = descriptor + 156;
+            } else if (descriptor[0] == 2 && descriptor[88] == '%' && descriptor[89] == '/' &&
+                       (descriptor[90] == '@' || descriptor[90] == 'C' || descriptor[90] == 'E')) {
+                jolietRoot = descriptor + 156;
+            } else if (descriptor[0] == 255) {
+                break;
+            }
+        }
+
+        if (!primaryRoot) {
+            return false;
+        }
+
+        // Rock Ridge keeps POSIX case and long names, Joliet keeps Unicode names;
+        // plain ISO9660 names are the last resort
+        const uint8_t* root = primaryRoot;
+        if (DetectRockRidge(primaryRoot)) {
+            isoNaming = IsoNaming::RockRidge;
+            formatName = "ISO9660 (Rock Ridge)";
+        } else if (jolietRoot) {
+            isoNaming = IsoNaming::Joliet;
+            root = jolietRoot;
+            formatName = "ISO9660 (Joliet)";
+        } else {
+            isoNaming = IsoNaming::Plain;
+            formatName = "ISO9660";
+        }
+
+        return WalkIsoDirectory(ReadLe32(root + 2), ReadLe32(root + 10), L"", 0);
+    }
+
+    // Rock Ridge is announced by a SUSP "SP" entry in the root directory's "." record
+    bool DetectRockRidge(const uint8_t* rootRecord) {
+        uint64_t offset = (uint64_t)ReadLe32(rootRecord + 2) * DISK_IMAGE_SECTOR_SIZE;
+        if (!InRange(offset, 34)) return false;
+
+        const uint8_t* dot = view + offset;
+        uint8_t recordLength = dot[0];
+        if (recordLength < 34 + 7 || !InRange(offset, recordLength)) return false;
+
+        const uint8_t* sp = dot + 34;
+        if (sp[0] == 'S' && sp[1] == 'P' && sp[4] == 0xBE && sp[5] == 0xEF) {
+            suspSkip = sp[6];
+            return true;
+        }
+        return false;
+    }
+
+    bool WalkIsoDirectory(uint32_t sector, uint32_t length, const std::wstring& prefix, int depth) {
+        uint64_t start = (uint64_t)sector * DISK_IMAGE_SECTOR_SIZE;
+        if (depth > MAX_DIRECTORY_DEPTH || !InRange(start, length)) return false;
+        if (!visitedDirectories.insert(start).second) return true;
+
+        // Files over 4 GB are split into several records flagged as multi-extent
+        bool continuing = false;
+        size_t continuingIndex = SIZE_MAX;
+
+        uint64_t pos = 0;
+        while (pos < length) {
+            // No record fits in fewer than 34 bytes; what is left can only be padding, and
+            // reading record fields there could run past the end of a truncated image
+            if (length - pos < 34) break;
+
+            const uint8_t* record = view + start + pos;
+            uint8_t recordLength = record[0];
+
+            // Records never straddle a sector; a zero length means skip to the next one
+            if (recordLength == 0) {
+                pos = (pos / DISK_IMAGE_SECTOR_SIZE + 1) * DISK_IMAGE_SECTOR_SIZE;
+                continue;
+            }
+
+            uint8_t nameLength = record[32];
+            if (recordLength < 34 || pos + recordLength > length || 33u + nameLength > recordLength) {
+                return false;
+            }
+            pos += recordLength;
+
+            uint8_t flags = record[25];
+            bool isDirectory = (flags & 0x02) != 0;
+            bool isDotEntry = nameLength == 1 && (record[33] == 0 || record[33] == 1);
+            if (isDotEntry || (flags & 0x04)) {
+                continue;
+            }
+
+            uint32_t extentSector = ReadLe32(record + 2) + record[1];
+            uint32_t dataLength = ReadLe32(record + 10);
+
+            if (isDirectory) {
+                std::wstring name = IsoRecordName(record, nameLength, recordLength);
+                if (SanitizeName(name)) {
+                    std::wstring path = prefix.empty() ? name : prefix + L"\\" + name;
+                    entries.push_back({path, true, 0, {}});
+                    if (!WalkIsoDirectory(extentSector, dataLength, path, depth + 1)) {
+                        return false;
+                    }
+                }
+                continuing = false;
+                continue;
+            }
+
+            Extent extent{(uint64_t)extentSector * DISK_IMAGE_SECTOR_SIZE, dataLength, false};
+            if (!InRange(extent.offset, extent.length)) {
+                return false;
+            }
+
+            if (!continuing) {
+                std::wstring name = IsoRecordName(record, nameLength, recordLength);
+                if (SanitizeName(name)) {
+                    std::wstring path = prefix.empty() ? name : prefix + L"\\" + name;
+                    entries.push_back({path, false, 0, {}});
+                    continuingIndex = entries.size() - 1;
+                } else {
+                    continuingIndex = SIZE_MAX;
+                }
+            }
+
+            if (continuingIndex != SIZE_MAX) {
+                entries[continuingIndex].extents.push_back(extent);
+                entries[continuingIndex].size += extent.length;
+            }
+            continuing = (flags & 0x80) != 0;
+        }
+
+        return true;
+    }
+
+    std::wstring IsoRecordName(const uint8_t* record, uint8_t nameLength, uint8_t recordLength) {
+        const uint8_t* name = record + 33;
+        std::wstring result;
+
+        if (isoNaming == IsoNaming::RockRidge) {
+            size_t suspOffset = 33 + nameLength + ((nameLength % 2 == 0) ? 1 : 0) + suspSkip;
+            if (suspOffset < recordLength) {
+                std::string rrName = ReadRockRidgeName(record + suspOffset, recordLength - suspOffset);
+                if (!rrName.empty()) {
+                    return Utf8ToWide(rrName.data(), rrName.size());
+                }
+            }
+        }
+
+        if (isoNaming == IsoNaming::Joliet) {
+            for (uint8_t i = 0; i + 1 < nameLength; i += 2) {
+                result.push_back((wchar_t)((name[i] << 8) | name[i + 1]));
+            }
+        } else {
+            result.assign(name, name + nameLength);
+        }
+
+        // Drop the ";1" version suffix and the trailing dot of extensionless names
+        size_t semicolon = result.find(L';');
+        if (semicolon != std::wstring::npos) {
+            result.erase(semicolon);
+        }
+        if (!result.empty() && result.back() == L'.') {
+            result.pop_back();
+        }
+        return result;
+    }
+
+    // Collects NM entries from the System Use area, following CE continuation areas
+    std::string ReadRockRidgeName(const uint8_t* area, size_t length) {
+        std::string name;
+
+        for (int hops = 0; hops < 8 && area; hops++) {
+            const uint8_t* next = nullptr;
+            size_t nextLength = 0;
+
+            while (length >= 4) {
+                uint8_t entryLength = area[2];
+                if (entryLength < 4 || entryLength > length) break;
+
+                if (area[0] == 'N' && area[1] == 'M' && entryLength >= 5 && !(area[4] & 0x06)) {
+                    name.append((const char*)area + 5, entryLength - 5);
+                } else if (area[0] == 'C' && area[1] == 'E' && entryLength >= 28) {
+                    uint64_t offset = (uint64_t)ReadLe32(area + 4) * DISK_IMAGE_SECTOR_SIZE + ReadLe32(area + 12);
+                    uint32_t continuationLength = ReadLe32(area + 20);
+                    if (InRange(offset, continuationLength)) {
+                        next = view + offset;
+                        nextLength = continuationLength;
+                    }
+                } else if (area[0] == 'S' && area[1] == 'T') {
+                    break;
+                }
+
+                area += entryLength;
+                length -= entryLength;
+            }
+
+            area = next;
+            length = nextLength;
+        }
+
+        return name;
+    }
+
+    // ---- UDF ----
+
+    bool HasUdfRecognitionSequence() const {
+        for (uint64_t sector = 16; sector < 64; sector++) {
+            uint64_t offset = sector * DISK_IMAGE_SECTOR_SIZE;
+            if (!InRange(offset, DISK_IMAGE_SECTOR_SIZE)) break;
+
+            const uint8_t* identifier = view + offset + 1;
+            if (memcmp(identifier, "NSR02", 5) == 0 || memcmp(identifier, "NSR03", 5) == 0) {
+                return true;
+            }
+            if (memcmp(identifier, "TEA01", 5) == 0) break;
+        }
+        return false;
+    }
+
+    uint64_t UdfBlockOffset(uint16_t partitionRef, uint32_t block) const {
+        if (partitionRef >= udfPartitionStart.size()) return UINT64_MAX;
+        return ((uint64_t)udfPartitionStart[partitionRef] + block) * DISK_IMAGE_SECTOR_SIZE;
+    }
+
+    bool ParseUdf() {
+        // Anchor Volume Descriptor Pointer lives at sector 256
+        uint64_t anchor = 256ull * DISK_IMAGE_SECTOR_SIZE;
+        if (!InRange(anchor, DISK_IMAGE_SECTOR_SIZE) || ReadLe16(view + anchor) != 2) {
+            return false;
+        }
+
+        uint32_t sequenceLength = ReadLe32(view + anchor + 16);
+        uint32_t sequenceSector = ReadLe32(view + anchor + 20);
+
+        std::map<uint16_t, uint32_t> partitionStarts;   // Partition number -> start sector
+        std::vector<uint16_t> partitionNumbers;         // Partition reference -> partition number
+        uint32_t logicalBlockSize = 0;
+        uint32_t fsdBlock = 0;
+        uint16_t fsdPartition = 0;
+
+        for (uint32_t i = 0; i < sequenceLength / DISK_IMAGE_SECTOR_SIZE; i++) {
+            uint64_t offset = ((uint64_t)sequenceSector + i) * DISK_IMAGE_SECTOR_SIZE;
+            if (!InRange(offset, DISK_IMAGE_SECTOR_SIZE)) break;
+
+            const uint8_t* descriptor = view + offset;
+            uint16_t tag = ReadLe16(descriptor);
+
+            if (tag == 5) {
+                // Partition Descriptor
+                partitionStarts[ReadLe16(descriptor + 22)] = ReadLe32(descriptor + 188);
+            } else if (tag == 6) {
+                // Logical Volume Descriptor
+                logicalBlockSize = ReadLe32(descriptor + 212);
+                fsdBlock = ReadLe32(descriptor + 252);
+                fsdPartition = ReadLe16(descriptor + 256);
+
+                uint32_t mapTableLength = std::min<uint32_t>(ReadLe32(descriptor + 264), DISK_IMAGE_SECTOR_SIZE - 440);
+                uint32_t mapCount = ReadLe32(descriptor + 268);
+                const uint8_t* map = descriptor + 440;
+                const uint8_t* mapEnd = map + mapTableLength;
+
+                partitionNumbers.clear();
+                for (uint32_t n = 0; n < mapCount && map + 2 <= mapEnd; n++) {
+                    uint8_t mapType = map[0];
+                    uint8_t mapLength = map[1];
+                    if (mapLength < 6 || map + mapLength > mapEnd) return false;
+
+                    if (mapType == 1) {
+                        partitionNumbers.push_back(ReadLe16(map + 4));
+                    } else if (mapLength >= 64 && memcmp(map + 5, "*UDF Sparable Partition", 23) == 0) {
+                        // Sparing only matters on rewritable media; an image reads through
+                        partitionNumbers.push_back(ReadLe16(map + 38));
+                    } else {
+                        // Virtual (VAT) and metadata partitions are left to PeaZip
+                        return false;
+                    }
+                    map += mapLength;
+                }
+            } else if (tag == 8) {
+                // Terminating Descriptor
+                break;
+            }
+        }
+
+        if (logicalBlockSize != DISK_IMAGE_SECTOR_SIZE || partitionNumbers.empty()) {
+            return false;
+        }
+
+        udfPartitionStart.clear();
+        for (uint16_t number : partitionNumbers) {
+            auto it = partitionStarts.find(number);
+            if (it == partitionStarts.end()) return false;
+            udfPartitionStart.push_back(it->second);
+        }
+
+        // File Set Descriptor points at the root directory ICB
+        uint64_t fsd = UdfBlockOffset(fsdPartition, fsdBlock);
+        if (!InRange(fsd, DISK_IMAGE_SECTOR_SIZE) || ReadLe16(view + fsd) != 256) {
+            return false;
+        }
+
+        uint32_t rootBlock = ReadLe32(view + fsd + 404);
+        uint16_t rootPartition = ReadLe16(view + fsd + 408);
+
+        UdfNode root;
+        if (!ReadUdfFileEntry(rootPartition, rootBlock, root) || !root.isDirectory) {
+            return false;
+        }
+        visitedDirectories.insert(((uint64_t)rootPartition << 32) | rootBlock);
+
+        return WalkUdfDirectory(root, L"", 0);
+    }
+
+    bool ReadUdfFileEntry(uint16_t partitionRef, uint32_t block, UdfNode& node) const {
+        uint64_t offset = UdfBlockOffset(partitionRef, block);
+        if (!InRange(offset, DISK_IMAGE_SECTOR_SIZE)) return false;
+
+        const uint8_t* fe = view + offset;
+        uint16_t tag = ReadLe16(fe);
+        uint32_t eaLength, adLength;
+        size_t adStart;
+
+        if (tag == 261) {
+            // File Entry
+            eaLength = ReadLe32(fe + 168);
+            adLength = ReadLe32(fe + 172);
+            adStart = 176;
+        } else if (tag == 266) {
+            // Extended File Entry
+            eaLength = ReadLe32(fe + 208);
+            adLength = ReadLe32(fe + 212);
+            adStart = 216;
+        } else {
+            return false;
+        }
+
+        if ((uint64_t)adStart + eaLength + adLength > DISK_IMAGE_SECTOR_SIZE) return false;
+
+        uint8_t fileType = fe[16 + 11];
+        uint16_t icbFlags = ReadLe16(fe + 16 + 18);
+        node.isDirectory = fileType == 4;
+        node.size = ReadLe64(fe + 56);
+        node.extents.clear();
+
+        uint64_t adPos = offset + adStart + eaLength;
+        uint64_t adEnd = adPos + adLength;
+        uint32_t adType = icbFlags & 0x07;
+
+        if (adType == 3) {
+            // Data embedded in the ICB itself
+            node.extents.push_back({adPos, std::min<uint64_t>(adLength, node.size), false});
+            return true;
+        }
+        if (adType > 2) return false;
+
+        size_t adSize = adType == 0 ? 8 : (adType == 1 ? 16 : 20);
+        int continuations = 0;
+
+        while (adPos + adSize <= adEnd) {
+            const uint8_t* ad = view + adPos;
+            uint32_t rawLength = ReadLe32(ad);
+            uint32_t length = rawLength & 0x3FFFFFFF;
+            uint32_t extentType = rawLength >> 30;
+            uint32_t extentBlock = adType == 2 ? ReadLe32(ad + 12) : ReadLe32(ad + 4);
+            uint16_t extentPartition = adType == 0 ? partitionRef : ReadLe16(ad + (adType == 1 ? 8 : 16));
+            adPos += adSize;
+
+            if (length == 0) break;
+
+            if (extentType == 3) {
+                // The descriptor list continues in an Allocation Extent Descriptor
+                uint64_t aed = UdfBlockOffset(extentPartition, extentBlock);
+                if (++continuations > 64 || !InRange(aed, 24) || ReadLe16(view + aed) != 258) return false;
+                uint32_t aedLength = ReadLe32(view + aed + 20);
+                if (!InRange(aed + 24, aedLength)) return false;
+                adPos = aed + 24;
+                adEnd = adPos + aedLength;
+                continue;
+            }
+
+            if (extentType == 0) {
+                uint64_t data = UdfBlockOffset(extentPartition, extentBlock);
+                if (!InRange(data, length)) return false;
+                node.extents.push_back({data, length, false});
+            } else {
+                node.extents.push_back({0, length, true});
+            }
+        }
+
+        // Extents are block-granular; trim the tail to the information length
+        uint64_t remaining = node.size;
+        for (auto& extent : node.extents) {
+            extent.length = std::min(extent.length, remaining);
+            remaining -= extent.length;
+        }
+        node.size -= remaining;
+        return true;
+    }
+
+    // OSTA compressed Unicode: 8 = one byte per character, 16 = UTF-16BE
+    static std::wstring DecodeOstaName(const uint8_t* bytes, size_t length) {
+        std::wstring name;
+        if (length == 0) return name;
+
+        uint8_t compression = bytes[0];
+        if (compression == 8 || compression == 254) {
+            name.assign(bytes + 1, bytes + length);
+        } else if (compression == 16 || compression == 255) {
+            for (size_t i = 1; i + 1 < length; i += 2) {
+                name.push_back((wchar_t)((bytes[i] << 8) | bytes[i + 1]));
+            }
+        }
+        return name;
+    }
+
+    bool WalkUdfDirectory(const UdfNode& directory, const std::wstring& prefix, int depth) {
+        if (depth > MAX_DIRECTORY_DEPTH) return false;
+
+        // Directories are small; gather the File Identifier Descriptors into one buffer
+        std::vector<uint8_t> data;
+        if (directory.size > 64ull * 1024 * 1024) return false;
+        for (const auto& extent : directory.extents) {
+            if (extent.sparse) {
+                data.insert(data.end(), extent.length, 0);
+            } else {
+                data.insert(data.end(), view + extent.offset, view + extent.offset + extent.length);
+            }
+        }
+
+        size_t pos = 0;
+        while (pos + 38 <= data.size()) {
+            const uint8_t* fid = data.data() + pos;
+            if (ReadLe16(fid) != 257) break;
+
+            uint8_t characteristics = fid[18];
+            uint8_t nameLength = fid[19];
+            uint32_t icbBlock = ReadLe32(fid + 24);
+            uint16_t icbPartition = ReadLe16(fid + 28);
+            uint16_t implementationUseLength = ReadLe16(fid + 36);
+
+            size_t nameOffset = 38 + implementationUseLength;
+            if (pos + nameOffset + nameLength > data.size()) break;
+
+            std::wstring name = DecodeOstaName(fid + nameOffset, nameLength);
+            pos += (nameOffset + nameLength + 3) & ~(size_t)3;
+
+            // Skip deleted entries and the parent link
+            if ((characteristics & 0x0C) || !SanitizeName(name)) {
+                continue;
+            }
+
+            UdfNode child;
+            if (!ReadUdfFileEntry(icbPartition, icbBlock, child)) {
+                return false;
+            }
+
+            std::wstring path = prefix.empty() ? name : prefix + L"\\" + name;
+            if (child.isDirectory) {
+                entries.push_back({path, true, 0, {}});
+                if (visitedDirectories.insert(((uint64_t)icbPartition << 32) | icbBlock).second &&
+                    !WalkUdfDirectory(child, path, depth + 1)) {
+                    return false;
+                }
+            } else {
+                entries.push_back({path, false, child.size, std::move(child.extents)});
+            }
+        }
+
+        return true;
+    }
+};
+
+// Opt-in span recorder that writes Chrome/Perfetto trace-event JSON. Spans are
+// buffered per thread and only merged when the recorder flushes to disk.
+class TraceRecorder {
+public:
+    static TraceRecorder& Instance() {
+        static TraceRecorder instance;
+        return instance;
+    }
+
+    bool Enable(const std::string& path) {
+        std::lock_guard<std::mutex> lock(registryMutex);
+        traceFile.open(path, std::ios::out | std::ios::trunc);
+        if (!traceFile.is_open()) {
+            return false;
+        }
+
+        // JSON array format: viewers accept a missing closing bracket, so the
+        // file stays loadable even if the service is killed between flushes
+        traceFile << "[\n";
+        eventsWritten = 0;
+        enabled = true;
+        return true;
+    }
+
+    bool IsEnabled() const {
+        return enabled.load(std::memory_order_relaxed);
+    }
+
+    uint64_t NowNs() const {
+        LARGE_INTEGER counter;
+        QueryPerformanceCounter(&counter);
+        uint64_t ticks = (uint64_t)counter.QuadPart;
+        return (ticks / frequency) * 1000000000ull + (ticks % frequency) * 1000000000ull / frequency;
+    }
+
+    uint32_t NextJobId() {
+        return ++jobCounter;
+    }
+
+    // Job id attached to every span recorded on the calling thread
+    static uint32_t& CurrentJob() {
+        static thread_local uint32_t jobId = 0;
+        return jobId;
+    }
+
+    void NameCurrentThread(const char* name) {
+        if (!IsEnabled()) return;
+        ThreadBuffer* buffer = LocalBuffer();
+        std::lock_guard<std::mutex> lock(buffer->mutex);
+        buffer->threadName = name;
+        buffer->nameWritten = false;
+    }
+
+    void Record(const char* name, uint64_t startNs, uint64_t endNs, const std::string& detail = std::string()) {
+        ThreadBuffer* buffer = LocalBuffer();
+        std::lock_guard<std::mutex> lock(buffer->mutex);
+        buffer->spans.push_back({name, startNs, endNs - startNs, CurrentJob(), detail});
+    }
+
+    // Drains every thread buffer into the trace file
+    void Flush() {
+        if (!IsEnabled()) return;
+
+        std::lock_guard<std::mutex> lock(registryMutex);
+        DWORD pid = GetCurrentProcessId();
+
+        for (auto it = buffers.begin(); it != buffers.end();) {
+            ThreadBuffer& buffer = **it;
+            std::vector<Span> spans;
+            bool retired;
+            {
+                std::lock_guard<std::mutex> bufferLock(buffer.mutex);
+                spans.swap(buffer.spans);
+                retired = buffer.retired;
+
+                if (!buffer.nameWritten && !buffer.threadName.empty()) {
+                    WriteSeparator();
+                    traceFile << "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":" << pid
+                              << ",\"tid\":" << buffer.threadId
+                              << ",\"args\":{\"name\":\"" << EscapeJson(buffer.threadName) << "\"}}";
+                    buffer.nameWritten = true;
+                }
+            }
+
+            for (const auto& span : spans) {
+                char timing[96];
+                snprintf(timing, sizeof(timing), "\"ts\":%llu.%03llu,\"dur\":%llu.%03llu",
+                         (unsigned long long)(span.startNs / 1000), (unsigned long long)(span.startNs % 1000),
+                         (unsigned long long)(span.durationNs / 1000), (unsigned long long)(span.durationNs % 1000));
+
+                WriteSeparator();
+                traceFile << "{\"name\":\"" << span.name << "\",\"cat\":\"job\",\"ph\":\"X\","
+                          << timing << ",\"pid\":" << pid << ",\"tid\":" << buffer.threadId
+                          << ",\"args\":{\"job\":" << span.jobId;
+                if (!span.detail.empty()) {
+                    traceFile << ",\"archive\":\"" << EscapeJson(span.detail) << "\"";
+                }
+                traceFile << "}}";
+            }
+
+            it = retired ? buffers.erase(it) : it + 1;
+        }
+
+        traceFile.flush();
+    }
+
+    void Shutdown() {
+        if (!IsEnabled()) return;
+        Flush();
+        std::lock_guard<std::mutex> lock(registryMutex);
+        enabled = false;
+        traceFile << "\n]\n";
+        traceFile.close();
+    }
+
+private:
+    struct Span {
+        const char* name;
+        uint64_t startNs;
+        uint64_t durationNs;
+        uint32_t jobId;
+        std::string detail;
+    };
+
+    struct ThreadBuffer {
+        std::mutex mutex;   // Only contended while Flush() drains this buffer
+        std::vector<Span> spans;
+        DWORD threadId = 0;
+        std::string threadName;
+        bool nameWritten = false;
+        bool retired = false;
+    };
+
+    // Marks the buffer for removal once the owning thread exits and it has been drained
+    struct BufferHandle {
+        ThreadBuffer* buffer = nullptr;
+
+        ~BufferHandle() {
+            if (buffer) {
+                std::lock_guard<std::mutex> lock(buffer->mutex);
+                buffer->retired = true;
+            }
+        }
+    };
+
+    std::atomic<bool> enabled{false};
+    std::atomic<uint32_t> jobCounter{0};
+    uint64_t frequency = 1;
+    std::mutex registryMutex;
+    std::vector<std::unique_ptr<ThreadBuffer>> buffers;
+    std::ofstream traceFile;
+    size_t eventsWritten = 0;
+
+    TraceRecorder() {
+        LARGE_INTEGER freq;
+        QueryPerformanceFrequency(&freq);
+        frequency = (uint64_t)freq.QuadPart;
+    }
+
+    ThreadBuffer* LocalBuffer() {
+        static thread_local BufferHandle handle;
+        if (!handle.buffer) {
+            auto buffer = std::make_unique<ThreadBuffer>();
+            buffer->threadId = GetCurrentThreadId();
+            handle.buffer = buffer.get();
+
+            std::lock_guard<std::mutex> lock(registryMutex);
+            buffers.push_back(std::move(buffer));
+        }
+        return handle.buffer;
+    }
+
+    void WriteSeparator() {
+        if (eventsWritten++ > 0) {
+            traceFile << ",\n";
+        }
+    }
+
+    static std::string EscapeJson(const std::string& text) {
+        std::string escaped;
+        for (char ch : text) {
+            if (ch == '"' || ch == '\\') {
+                escaped += '\\';
+                escaped += ch;
+            } else if ((unsigned char)ch < 0x20) {
+                char code[8];
+                snprintf(code, sizeof(code), "\\u%04x", ch);
+                escaped += code;
+            } else {
+                escaped += ch;
+            }
+        }
+        return escaped;
+    }
+};
+
+// Records one trace span for the enclosing scope. A single relaxed load when tracing is off.
+class TraceSpan {
+public:
+    explicit TraceSpan(const char* name) : name(name) {
+        if (TraceRecorder::Instance().IsEnabled()) {
+            startNs = TraceRecorder::Instance().NowNs();
+        }
+    }
+
+    TraceSpan(const TraceSpan&) = delete;
+    TraceSpan& operator=(const TraceSpan&) = delete;
+
+    ~TraceSpan() {
+        End();
+    }
+
+    // Fixes the end time but leaves recording to End() or the destructor, so a span taken
+    // before its job id is known is still attributed to that job
+    void Stop() {
+        if (startNs && !endNs) {
+            endNs = TraceRecorder::Instance().NowNs();
+        }
+    }
+
+    void End() {
+        if (startNs) {
+            TraceRecorder::Instance().Record(name, startNs, endNs ? endNs : TraceRecorder::Instance().NowNs());
+            startNs = 0;
+        }
+    }
+
+private:
+    const char* name;
+    uint64_t startNs = 0;
+    uint64_t endNs = 0;
+};
+
+// Tags spans on this thread with a fresh job id and records the overall job span,
+// labelled with the archive name, when the scope ends
+class TraceJobScope {
+public:
+    explicit TraceJobScope(const std::string& archiveName) {
+        TraceRecorder& recorder = TraceRecorder::Instance();
+        if (recorder.IsEnabled()) {
+            previousJob = TraceRecorder::CurrentJob();
+            TraceRecorder::CurrentJob() = recorder.NextJobId();
+            label = archiveName;
+            startNs = recorder.NowNs();
+        }
+    }
+
+    TraceJobScope(const TraceJobScope&) = delete;
+    TraceJobScope& operator=(const TraceJobScope&) = delete;
+
+    ~TraceJobScope() {
+        if (startNs) {
+            TraceRecorder& recorder = TraceRecorder::Instance();
+            recorder.Record("job", startNs, recorder.NowNs(), label);
+            TraceRecorder::CurrentJob() = previousJob;
+            recorder.Flush();
+        }
+    }
+
+private:
+    std::string label;
+    uint32_t previousJob = 0;
+    uint64_t startNs = 0;
+};
+
+// Why an extraction did not succeed, as far as the backend can tell
+enum class ExtractionFailure {
+    None,
+    EngineMissing,
+    SpawnFailed,
+    Timeout,
+    WrongPassword,
+    CorruptData,
+    UnsupportedFormat,
+    DiskFull,
+    FileLocked,
+    AccessDenied,
+    OutOfMemory,
+    Unknown
+};
+
+const char* FailureReasonName(ExtractionFailure failure) {
+    switch (failure) {
+        case ExtractionFailure::None: return "none";
+        case ExtractionFailure::EngineMissing: return "engine not found";
+        case ExtractionFailure::SpawnFailed: return "engine failed to start";
+        case ExtractionFailure::Timeout: return "timed out";
+        case ExtractionFailure::WrongPassword: return "wrong password";
+        case ExtractionFailure::CorruptData: return "corrupt data";
+        case ExtractionFailure::UnsupportedFormat: return "unsupported format";
+        case ExtractionFailure::DiskFull: return "disk full";
+        case ExtractionFailure::FileLocked: return "file locked";
+        case ExtractionFailure::AccessDenied: return "access denied";
+        case ExtractionFailure::OutOfMemory: return "out of memory";
+        default: return "unknown";
+    }
+}
+
+// Failures that may clear up on their own (antivirus holding the file, a full disk being
+// cleaned, a busy machine) and are worth retrying; everything else fails fast
+bool IsTransientFailure(ExtractionFailure failure) {
+    switch (failure) {
+        case ExtractionFailure::FileLocked:
+        case ExtractionFailure::DiskFull:
+        case ExtractionFailure::OutOfMemory:
+        case ExtractionFailure::Timeout:
+            return true;
+        default:
+            return false;
+    }
+}
+
+// Classifies a failed CreatePipe/CreateProcess from its GetLastError() code. Only resource
+// shortages and sharing conflicts are worth retrying; anything else (a missing or broken
+// executable, a bad path) is a configuration problem that fails fast as SpawnFailed.
+ExtractionFailure SpawnFailure(DWORD lastError) {
+    switch (lastError) {
+        case ERROR_NOT_ENOUGH_MEMORY:
+        case ERROR_OUTOFMEMORY:
+        case ERROR_NO_SYSTEM_RESOURCES:
+        case ERROR_COMMITMENT_LIMIT:
+            return ExtractionFailure::OutOfMemory;
+        case ERROR_SHARING_VIOLATION:
+        case ERROR_LOCK_VIOLATION:
+            return ExtractionFailure::FileLocked;
+        default:
+            return ExtractionFailure::SpawnFailed;
+    }
+}
+
+// Runs PeaZip's bundled 7-Zip engine (or a system-wide 7-Zip) directly instead of going
+// through the peazip.exe front-end, and parses its progress and messages from a pipe
+class SevenZipEngine {
+public:
+    struct Result {
+        ExtractionFailure failure = ExtractionFailure::Unknown;
+        DWORD exitCode = 0;
+        std::string detail;          // First error line reported by the engine
+        size_t filesExtracted = 0;
+        std::string lastItem;        // Last item -bb1 listed, relative to the output folder
+        uint64_t firstOutputNs = 0;  // Process creation to first byte on stdout
+        uint64_t totalNs = 0;
+    };
+
+    explicit SevenZipEngine(const std::string& enginePath) : enginePath(enginePath) {}
+
+    static std::string Locate(const std::string& peazipPath) {
+        std::vector<std::string> candidates;
+
+        // PeaZip ships the engine under res\bin\7z (res\7z in older releases)
+        if (!peazipPath.empty()) {
+            std::string peazipDir = peazipPath.substr(0, peazipPath.find_last_of("\\/"));
+            candidates.push_back(peazipDir + "\\res\\bin\\7z\\7z.exe");
+            candidates.push_back(peazipDir + "\\res\\7z\\7z.exe");
+            candidates.push_back(peazipDir + "\\res\\bin\\7z\\7za.exe");
+        }
+
+        // System-wide 7-Zip installation
+        HKEY hKey;
+        if (RegOpenKeyExA(HKEY_LOCAL_MACHINE, "SOFTWARE\\7-Zip", 0, KEY_READ, &hKey) == ERROR_SUCCESS) {
+            for (const char* valueName : {"Path64", "Path"}) {
+                char buffer[MAX_PATH];
+                DWORD bufferSize = sizeof(buffer);
+                if (RegQueryValueExA(hKey, valueName, NULL, NULL, (LPBYTE)buffer, &bufferSize) == ERROR_SUCCESS) {
+                    std::string installDir(buffer);
+                    if (!installDir.empty() && installDir.back() == '\\') installDir.pop_back();
+                    candidates.push_back(installDir + "\\7z.exe");
+                }
+            }
+            RegCloseKey(hKey);
+        }
+        candidates.push_back("C:\\Program Files\\7-Zip\\7z.exe");
+        candidates.push_back("C:\\Program Files (x86)\\7-Zip\\7z.exe");
+
+        for (const auto& path : candidates) {
+            if (std::filesystem::exists(path)) {
+                return path;
+            }
+        }
+        return "";
+    }
+
+    Result Extract(const std::string& archivePath, const std::string& outputDir,
+                   const std::string& password, DWORD timeoutMs) const {
+        Result result;
+
+        // -bso1/-bse1/-bsp1 send messages, errors and progress to the one stdout pipe;
+        // -bb1 lists each extracted file. An explicit, possibly empty, -p keeps the
+        // engine from waiting on stdin for a password.
+        std::string command = "\"" + enginePath + "\" x -y -aoa -bb1 -bso1 -bse1 -bsp1 ";
+        command += "-p\"" + password + "\" ";
+        command += "-o\"" + outputDir + "\" ";
+        command += "\"" + archivePath + "\"";
+
+        SECURITY_ATTRIBUTES sa = {sizeof(sa), NULL, TRUE};
+        HANDLE hReadPipe, hWritePipe;
+        if (!CreatePipe(&hReadPipe, &hWritePipe, &sa, 0)) {
+            DWORD pipeError = GetLastError();
+            result.failure = SpawnFailure(pipeError);
+            result.detail = "CreatePipe failed with error " + std::to_string(pipeError);
+            return result;
+        }
+        SetHandleInformation(hReadPipe, HANDLE_FLAG_INHERIT, 0);
+        HANDLE hNul = CreateFileA("NUL", GENERIC_READ, FILE_SHARE_READ | FILE_SHARE_WRITE,
+                                  &sa, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+
+        STARTUPINFOA si = {sizeof(si)};
+        PROCESS_INFORMATION pi;
+        si.dwFlags = STARTF_USESHOWWINDOW | STARTF_USESTDHANDLES;
+        si.wShowWindow = SW_HIDE;
+        si.hStdInput = hNul;
+        si.hStdOutput = hWritePipe;
+        si.hStdError = hWritePipe;
+
+        TraceRecorder& clock = TraceRecorder::Instance();
+        uint64_t startNs = clock.NowNs();
+
+        BOOL started = CreateProcessA(NULL, &command[0], NULL, NULL, TRUE,
+                                      CREATE_NO_WINDOW, NULL, NULL, &si, &pi);
+        DWORD spawnError = started ? 0 : GetLastError();
+
+        // Only the child may hold the write end, or ReadFile never sees EOF
+        CloseHandle(hWritePipe);
+        if (hNul != INVALID_HANDLE_VALUE) CloseHandle(hNul);
+
+        if (!started) {
+            CloseHandle(hReadPipe);
+            result.failure = SpawnFailure(spawnError);
+            result.detail = "CreateProcess failed with error " + std::to_string(spawnError);
+            return result;
+        }
+
+        OutputParser parser;
+        std::atomic<uint64_t> firstOutputNs{0};
+        std::thread reader([&]() {
+            char buffer[4096];
+            DWORD bytesRead = 0;
+            while (ReadFile(hReadPipe, buffer, sizeof(buffer), &bytesRead, NULL) && bytesRead > 0) {
+                if (!firstOutputNs) firstOutputNs = clock.NowNs();
+                parser.Feed(buffer, bytesRead);
+            }
+            parser.Finish();
+        });
+
+        DWORD waitResult = WaitForSingleObject(pi.hProcess, timeoutMs);
+        bool timedOut = waitResult != WAIT_OBJECT_0;
+        if (timedOut) {
+            TerminateProcess(pi.hProcess, 1);
+            WaitForSingleObject(pi.hProcess, 5000);
+        }
+
+        DWORD exitCode = 1;
+        GetExitCodeProcess(pi.hProcess, &exitCode);
+        reader.join();
+
+        CloseHandle(hReadPipe);
+        CloseHandle(pi.hProcess);
+        CloseHandle(pi.hThread);
+
+        uint64_t endNs = clock.NowNs();
+        uint64_t firstNs = firstOutputNs ? firstOutputNs.load() : endNs;
+        if (clock.IsEnabled()) {
+            clock.Record("spawn", startNs, firstNs);
+            clock.Record("decompress", firstNs, endNs);
+        }
+
+        result.exitCode = exitCode;
+        result.detail = parser.firstError;
+        result.filesExtracted = parser.filesExtracted;
+        result.lastItem = parser.lastItem;
+        result.firstOutputNs = firstNs - startNs;
+        result.totalNs = endNs - startNs;
+
+        if (timedOut) {
+            result.failure = ExtractionFailure::Timeout;
+        } else if (exitCode == 0 || (exitCode == 1 && parser.reportedFailure == ExtractionFailure::None)) {
+            // 1 is a warning; without a classified error the archive itself was extracted
+            result.failure = ExtractionFailure::None;
+        } else if (parser.reportedFailure != ExtractionFailure::None) {
+            result.failure = parser.reportedFailure;
+        } else if (exitCode == 8) {
+            result.failure = ExtractionFailure::OutOfMemory;
+        } else {
+            result.failure = ExtractionFailure::Unknown;
+        }
+        return result;
+    }
+
+private:
+    std::string enginePath;
+
+    struct OutputParser {
+        std::string line;
+        size_t filesExtracted = 0;
+        std::string lastItem;
+        ExtractionFailure reportedFailure = ExtractionFailure::None;
+        std::string firstError;
+
+        void Feed(const char* data, size_t length) {
+            for (size_t i = 0; i < length; i++) {
+                char ch = data[i];
+                // -bsp1 redraws its progress line with backspaces and carriage returns
+                if (ch == '\n' || ch == '\r' || ch == '\b') {
+                    Finish();
+                } else if (line.size() < 4096) {
+                    line += ch;
+                }
+            }
+        }
+
+        void Finish() {
+            if (line.find_first_not_of(' ') != std::string::npos) {
+                ParseLine();
+            }
+            line.clear();
+        }
+
+        void ParseLine() {
+            // -bb1 reports every extracted item as "- name"
+            if (line.rfind("- ", 0) == 0) {
+                filesExtracted++;
+                lastItem.assign(line, 2);
+                return;
+            }
+
+            ExtractionFailure failure = ClassifyMessage(line);
+            if (failure != ExtractionFailure::None && reportedFailure == ExtractionFailure::None) {
+                reportedFailure = failure;
+                firstError = line;
+            }
+        }
+    };
+
+    static ExtractionFailure ClassifyMessage(std::string message) {
+        std::transform(message.begin(), message.end(), message.begin(), ::tolower);
+
+        // Order matters: "Data Error in encrypted file. Wrong password?" is a password problem
+        if (message.find("wrong password") != std::string::npos) {
+            return ExtractionFailure::WrongPassword;
+        }
+        if (message.find("not enough space") != std::string::npos) {
+            return ExtractionFailure::DiskFull;
+        }
+        if (message.find("being used by another process") != std::string::npos ||
+            message.find("sharing violation") != std::string::npos) {
+            return ExtractionFailure::FileLocked;
+        }
+        if (message.find("access is denied") != std::string::npos) {
+            return ExtractionFailure::AccessDenied;
+        }
+        if (message.find("can't allocate") != std::string::npos ||
+            message.find("not enough memory") != std::string::npos) {
+            return ExtractionFailure::OutOfMemory;
+        }
+        if (message.find("can not open the file as archive") != std::string::npos ||
+            message.find("cannot open the file as archive") != std::string::npos ||
+            message.find("unsupported method") != std::string::npos) {
+            return ExtractionFailure::UnsupportedFormat;
+        }
+        if (message.find("data error") != std::string::npos ||
+            message.find("crc failed") != std::string::npos ||
+            message.find("headers error") != std::string::npos ||
+            message.find("unexpected end of archive") != std::string::npos) {
+            return ExtractionFailure::CorruptData;
+        }
+        return ExtractionFailure::None;
+    }
+};
+
+// Block-parallel decoder for single-file .xz, .bz2, .gz and .zst streams. The stream is
+// split at independent blocks/frames, each chunk is re-wrapped as a standalone stream and
+// piped through its own engine process, and a reorder buffer writes output in order.
+class ParallelStreamDecoder {
+public:
+    enum class Format { Unknown, Gzip, Bzip2, Xz, Zstd };
+
+    bool Open(const std::string& path) {
+        if (!input.Open(path)) {
+            return false;
+        }
+        format = DetectFormat(input.Data(), input.Size());
+        return format != Format::Unknown;
+    }
+
+    Format StreamFormat() const { return format; }
+    size_t ChunkCount() const { return chunks.size(); }
+    uint64_t InputSize() const { return input.Size(); }
+
+    static const char* FormatName(Format format) {
+        switch (format) {
+            case Format::Gzip: return "gzip";
+            case Format::Bzip2: return "bzip2";
+            case Format::Xz: return "xz";
+            case Format::Zstd: return "zstd";
+            default: return "unknown";
+        }
+    }
+
+    static Format DetectFormat(const uint8_t* data, uint64_t size) {
+        if (size >= 18 && data[0] == 0x1F && data[1] == 0x8B && data[2] == 0x08) return Format::Gzip;
+        if (size >= 14 && memcmp(data, "BZh", 3) == 0 && data[3] >= '1' && data[3] <= '9') return Format::Bzip2;
+        if (size >= 32 && memcmp(data, "\xFD" "7zXZ\0", 6) == 0) return Format::Xz;
+        if (size >= 9 && ReadLe32(data) == ZSTD_FRAME_MAGIC) return Format::Zstd;
+        return Format::Unknown;
+    }
+
+    // Compressed bytes per chunk: two chunks per thread, between 1 MB and 16 MB
+    static uint64_t TargetChunkSize(uint64_t inputSize, unsigned threads) {
+        return std::clamp<uint64_t>(inputSize / (std::max(threads, 1u) * 2ull), 1ull << 20, 16ull << 20);
+    }
+
+    // Finds independent chunks. Returns false when the stream cannot be split into at
+    // least two chunks; zstd is always planned because only this stage handles it.
+    bool Plan(unsigned threads) {
+        chunks.clear();
+        uint64_t targetChunkSize = TargetChunkSize(input.Size(), threads);
+
+        bool planned = false;
+        switch (format) {
+            case Format::Xz: planned = PlanXz(targetChunkSize); break;
+            case Format::Zstd: planned = PlanZstd(targetChunkSize); break;
+            case Format::Gzip: planned = PlanGzip(targetChunkSize); break;
+            case Format::Bzip2: planned = PlanBzip2(targetChunkSize, threads); break;
+            default: break;
+        }
+
+        return planned && (chunks.size() > 1 || format == Format::Zstd);
+    }
+
+    // decoderCommand must read the stream on stdin and write plain data to stdout. The chunk
+    // the output file is waiting for streams straight into it; chunks decoded ahead of it
+    // keep at most bufferBytes / windowChunks in memory each and spill the rest to a
+    // temporary file next to the output. A decoder still running after chunkTimeoutMs is
+    // terminated and the job fails with ExtractionFailure::Timeout.
+    bool DecodeTo(const std::string& outputPath, const std::string& decoderCommand, unsigned threads,
+                  size_t windowChunks, uint64_t bufferBytes, DWORD chunkTimeoutMs,
+                  ExtractionFailure& failure, std::string& error) {
+        failure = ExtractionFailure::None;
+        HANDLE hOut = CreateFileA(outputPath.c_str(), GENERIC_WRITE, 0, NULL, CREATE_ALWAYS,
+                                  FILE_ATTRIBUTE_NORMAL | FILE_FLAG_SEQUENTIAL_SCAN, NULL);
+        if (hOut == INVALID_HANDLE_VALUE) {
+            error = "Cannot create " + outputPath;
+            failure = ExtractionFailure::AccessDenied;
+            return false;
+        }
+
+        windowChunks = std::max<size_t>(windowChunks, 1);
+        std::string spillDir = outputPath.substr(0, outputPath.find_last_of("\\/"));
+        std::vector<ChunkOutput> outputs(chunks.size());
+        ChunkOutput::Limits limits{spillDir, bufferBytes / windowChunks};
+
+        // nextToWrite is the chunk that owns the output file. Its worker writes directly;
+        // when it finishes it flushes any finished successors and hands ownership on.
+        std::mutex mutex;
+        std::condition_variable changed;
+        std::atomic<size_t> nextToWrite{0};
+        size_t nextToDecode = 0;
+        std::atomic<bool> failed{false};
+
+        auto fail = [&](const std::string& reason, ExtractionFailure kind) {
+            std::lock_guard<std::mutex> lock(mutex);
+            if (!failed) {
+                error = reason;
+                failure = kind;
+            }
+            failed = true;
+            changed.notify_all();
+        };
+
+        auto failWrite = [&]() {
+            DWORD lastError = GetLastError();
+            bool diskFull = lastError == ERROR_DISK_FULL || lastError == ERROR_HANDLE_DISK_FULL;
+            fail("Write failed (error " + std::to_string(lastError) + ")",
+                 diskFull ? ExtractionFailure::DiskFull : ExtractionFailure::Unknown);
+        };
+
+        // Workers may run at most windowChunks ahead of the output
+        auto worker = [&]() {
+            try {
+                for (;;) {
+                    size_t index;
+                    {
+                        std::unique_lock<std::mutex> lock(mutex);
+                        changed.wait(lock, [&]() {
+                            return failed || nextToDecode >= chunks.size() || nextToDecode < nextToWrite + windowChunks;
+                        });
+                        if (failed || nextToDecode >= chunks.size()) return;
+                        index = nextToDecode++;
+                    }
+
+                    ChunkOutput& output = outputs[index];
+                    bool writeOk = true;
+                    bool cancelled = false;
+                    bool timedOut = false;
+                    bool ok = RunDecoder(decoderCommand, chunks[index], chunkTimeoutMs, timedOut,
+                                         [&](const uint8_t* data, size_t length) {
+                        // Another chunk already failed the job; stop this decoder too
+                        if (failed) {
+                            cancelled = true;
+                            return false;
+                        }
+                        if (nextToWrite == index) {
+                            writeOk = output.FlushTo(hOut) && WriteAll(hOut, data, length);
+                        } else {
+                            writeOk = output.Append(data, length, chunks[index].decodedSize, limits);
+                        }
+                        return writeOk;
+                    });
+
+                    if (cancelled) {
+                        return;
+                    }
+                    if (!writeOk) {
+                        failWrite();
+                        return;
+                    }
+                    if (timedOut) {
+                        fail("Decoder timed out on chunk " + std::to_string(index), ExtractionFailure::Timeout);
+                        return;
+                    }
+                    if (!ok) {
+                        fail("Decoder failed on chunk " + std::to_string(index), ExtractionFailure::Unknown);
+                        return;
+                    }
+
+                    std::unique_lock<std::mutex> lock(mutex);
+                    output.done = true;
+                    if (nextToWrite != index) {
+                        // The worker that owns the output will flush this chunk
+                        continue;
+                    }
+
+                    size_t next = index;
+                    while (next < chunks.size() && outputs[next].done) {
+                        lock.unlock();
+                        if (!outputs[next].FlushTo(hOut)) {
+                            failWrite();
+                            return;
+                        }
+                        lock.lock();
+                        next++;
+                    }
+                    nextToWrite = next;
+                    changed.notify_all();
+                }
+            } catch (const std::bad_alloc&) {
+                // Fail the job rather than the process; the caller falls back to one stream
+                fail("Out of memory", ExtractionFailure::OutOfMemory);
+            }
+        };
+
+        std::vector<std::thread> workers;
+        size_t workerCount = std::min<size_t>(std::max(threads, 1u), chunks.size());
+        for (size_t i = 0; i < workerCount; i++) {
+            workers.emplace_back(worker);
+        }
+        for (auto& thread : workers) {
+            thread.join();
+        }
+
+        for (auto& output : outputs) {
+            output.Discard();
+        }
+        CloseHandle(hOut);
+
+        if (failed) {
+            DeleteFileA(outputPath.c_str());
+        }
+        return !failed;
+    }
+
+private:
+    static constexpr uint32_t ZSTD_FRAME_MAGIC = 0xFD2FB528;
+    static constexpr uint64_t BZIP2_BLOCK_MAGIC = 0x314159265359ull;
+    static constexpr uint64_t BZIP2_END_MAGIC = 0x177245385090ull;
+
+    struct Bzip2Block {
+        uint64_t startBit;
+        uint64_t endBit;
+        uint32_t crc;
+        uint64_t length;   // In bytes, for grouping
+    };
+
+    // A standalone stream: synthesized prefix, a slice of the input, synthesized suffix.
+    // bzip2 blocks are not byte aligned, so a bzip2 chunk lists its blocks instead and
+    // the feeder re-packs them from data into a new stream as it writes to the decoder.
+    struct StreamChunk {
+        std::vector<uint8_t> prefix;
+        const uint8_t* data = nullptr;
+        uint64_t length = 0;
+        std::vector<uint8_t> suffix;
+        std::vector<Bzip2Block> bzip2Blocks;
+        uint64_t decodedSize = 0;   // From the xz index or zstd frame headers; 0 if unknown
+    };
+
+    // Output of a chunk decoded ahead of the file position: memory up to a cap, then a
+    // delete-on-close temporary file
+    struct ChunkOutput {
+        struct Limits {
+            std::string spillDir;
+            uint64_t memoryBytes;
+        };
+
+        std::vector<uint8_t> memory;
+        HANDLE spill = INVALID_HANDLE_VALUE;
+        bool done = false;
+
+        bool Append(const uint8_t* data, size_t length, uint64_t decodedSize, const Limits& limits) {
+            if (spill == INVALID_HANDLE_VALUE && memory.size() + length <= limits.memoryBytes) {
+                if (memory.empty()) {
+                    memory.reserve((size_t)std::min<uint64_t>(decodedSize ? decodedSize : 1ull << 20,
+                                                              limits.memoryBytes));
+                }
+                memory.insert(memory.end(), data, data + length);
+                return true;
+            }
+
+            if (spill == INVALID_HANDLE_VALUE) {
+                char spillPath[MAX_PATH];
+                if (!GetTempFileNameA(limits.spillDir.c_str(), "auz", 0, spillPath)) {
+                    return false;
+                }
+                spill = CreateFileA(spillPath, GENERIC_READ | GENERIC_WRITE, 0, NULL, CREATE_ALWAYS,
+                                    FILE_ATTRIBUTE_TEMPORARY | FILE_FLAG_DELETE_ON_CLOSE, NULL);
+                if (spill == INVALID_HANDLE_VALUE) {
+                    DeleteFileA(spillPath);
+                    return false;
+                }
+            }
+            return WriteAll(spill, data, length);
+        }
+
+        // Writes everything buffered so far to hOut and releases it
+        bool FlushTo(HANDLE hOut) {
+            bool ok = WriteAll(hOut, memory.data(), memory.size());
+            std::vector<uint8_t>().swap(memory);
+
+            if (ok && spill != INVALID_HANDLE_VALUE) {
+                LARGE_INTEGER zero = {};
+                ok = SetFilePointerEx(spill, zero, NULL, FILE_BEGIN);
+
+                char buffer[64 * 1024];
+                DWORD bytesRead = 0;
+                while (ok && ReadFile(spill, buffer, sizeof(buffer), &bytesRead, NULL) && bytesRead > 0) {
+                    ok = WriteAll(hOut, (const uint8_t*)buffer, bytesRead);
+                }
+            }
+            Discard();
+            return ok;
+        }
+
+        void Discard() {
+            std::vector<uint8_t>().swap(memory);
+            if (spill != INVALID_HANDLE_VALUE) {
+                CloseHandle(spill);
+                spill = INVALID_HANDLE_VALUE;
+            }
+        }
+    };
+
+    MappedFile input;
+    Format format = Format::Unknown;
+    std::vector<StreamChunk> chunks;
+
+    static uint32_t ReadLe32(const uint8_t* p) {
+        return (uint32_t)p[0] | ((uint32_t)p[1] << 8) | ((uint32_t)p[2] << 16) | ((uint32_t)p[3] << 24);
+    }
+
+    static bool WriteAll(HANDLE hFile, const uint8_t* data, size_t length) {
+        while (length > 0) {
+            DWORD chunk = (DWORD)std::min<size_t>(length, 64u * 1024 * 1024);
+            DWORD written = 0;
+            if (!WriteFile(hFile, data, chunk, &written, NULL) || written != chunk) return false;
+            data += chunk;
+            length -= chunk;
+        }
+        return true;
+    }
+
+    static void AppendLe32(std::vector<uint8_t>& out, uint32_t value) {
+        for (int i = 0; i < 4; i++) {
+            out.push_back((uint8_t)(value >> (8 * i)));
+        }
+    }
+
+    static uint32_t Crc32(const uint8_t* data, size_t length) {
+        static const std::vector<uint32_t> table = []() {
+            std::vector<uint32_t> t(256);
+            for (uint32_t i = 0; i < 256; i++) {
+                uint32_t c = i;
+                for (int k = 0; k < 8; k++) c = (c & 1) ? 0xEDB88320u ^ (c >> 1) : c >> 1;
+                t[i] = c;
+            }
+            return t;
+        }();
+
+        uint32_t crc = 0xFFFFFFFFu;
+        for (size_t i = 0; i < length; i++) {
+            crc = table[(crc ^ data[i]) & 0xFF] ^ (crc >> 8);
+        }
+        return crc ^ 0xFFFFFFFFu;
+    }
+
+    // Groups consecutive [offset, length) pieces into chunks of roughly targetSize bytes
+    template <typename T, typename MakeChunk>
+    void GroupPieces(const std::vector<T>& pieces, uint64_t targetSize, MakeChunk makeChunk) {
+        size_t first = 0;
+        uint64_t accumulated = 0;
+        for (size_t i = 0; i < pieces.size(); i++) {
+            accumulated += pieces[i].length;
+            if (accumulated >= targetSize || i + 1 == pieces.size()) {
+                chunks.push_back(makeChunk(first, i + 1));
+                first = i + 1;
+                accumulated = 0;
+            }
+        }
+    }
+
+    // ---- xz: the index at the end lists every block's size ----
+
+    static bool ReadVarint(const uint8_t*& p, const uint8_t* end, uint64_t& value) {
+        value = 0;
+        for (int shift = 0; shift < 63 && p < end; shift += 7) {
+            uint8_t byte = *p++;
+            value |= (uint64_t)(byte & 0x7F) << shift;
+            if (!(byte & 0x80)) return true;
+        }
+        return false;
+    }
+
+    static void AppendVarint(std::vector<uint8_t>& out, uint64_t value) {
+        while (value >= 0x80) {
+            out.push_back((uint8_t)(value | 0x80));
+            value >>= 7;
+        }
+        out.push_back((uint8_t)value);
+    }
+
+    bool PlanXz(uint64_t targetChunkSize) {
+        const uint8_t* data = input.Data();
+        uint64_t size = input.Size();
+
+        // Single stream only: header, blocks, index, footer with no stream padding
+        const uint8_t* footer = data + size - 12;
+        if (footer[10] != 'Y' || footer[11] != 'Z' || memcmp(footer + 8, data + 6, 2) != 0) {
+            return false;
+        }
+
+        uint64_t indexSize = ((uint64_t)ReadLe32(footer + 4) + 1) * 4;
+        if (indexSize + 24 > size) return false;
+
+        const uint8_t* index = footer - indexSize;
+        const uint8_t* indexEnd = footer - 4;
+        const uint8_t* p = index;
+        uint64_t recordCount;
+        if (*p++ != 0x00 || !ReadVarint(p, indexEnd, recordCount) || recordCount > size / 12) {
+            return false;
+        }
+
+        struct XzBlock {
+            uint64_t offset;
+            uint64_t length;        // Including block padding
+            uint64_t unpaddedSize;
+            uint64_t uncompressedSize;
+        };
+
+        std::vector<XzBlock> blocks;
+        uint64_t offset = 12;
+        for (uint64_t i = 0; i < recordCount; i++) {
+            XzBlock block;
+            if (!ReadVarint(p, indexEnd, block.unpaddedSize) || !ReadVarint(p, indexEnd, block.uncompressedSize)) {
+                return false;
+            }
+            block.offset = offset;
+            block.length = (block.unpaddedSize + 3) & ~3ull;
+            offset += block.length;
+            blocks.push_back(block);
+        }
+
+        if (offset != size - 12 - indexSize) {
+            return false;
+        }
+
+        GroupPieces(blocks, targetChunkSize, [&](size_t first, size_t last) {
+            StreamChunk chunk;
+            chunk.prefix.assign(data, data + 12);
+            chunk.data = data + blocks[first].offset;
+            chunk.length = blocks[last - 1].offset + blocks[last - 1].length - blocks[first].offset;
+            for (size_t i = first; i < last; i++) {
+                chunk.decodedSize += blocks[i].uncompressedSize;
+            }
+
+            // Index for just these blocks, then a matching stream footer
+            std::vector<uint8_t>& suffix = chunk.suffix;
+            suffix.push_back(0x00);
+            AppendVarint(suffix, last - first);
+            for (size_t i = first; i < last; i++) {
+                AppendVarint(suffix, blocks[i].unpaddedSize);
+                AppendVarint(suffix, blocks[i].uncompressedSize);
+            }
+            while (suffix.size() % 4) suffix.push_back(0);
+            AppendLe32(suffix, Crc32(suffix.data(), suffix.size()));
+
+            std::vector<uint8_t> footerFields;
+            AppendLe32(footerFields, (uint32_t)(suffix.size() / 4 - 1));
+            footerFields.push_back(data[6]);
+            footerFields.push_back(data[7]);
+            AppendLe32(suffix, Crc32(footerFields.data(), footerFields.size()));
+            suffix.insert(suffix.end(), footerFields.begin(), footerFields.end());
+            suffix.push_back('Y');
+            suffix.push_back('Z');
+            return chunk;
+        });
+        return true;
+    }
+
+    // ---- zstd: frames are self-delimiting and each one is a valid stream ----
+
+    struct Piece {
+        uint64_t offset;
+        uint64_t length;
+        uint64_t decodedSize = 0;
+    };
+
+    bool PlanZstd(uint64_t targetChunkSize) {
+        const uint8_t* data = input.Data();
+        uint64_t size = input.Size();
+        std::vector<Piece> frames;
+
+        uint64_t pos = 0;
+        while (pos < size) {
+            if (pos + 8 > size) return false;
+            uint64_t start = pos;
+            uint64_t decodedSize = 0;
+            uint32_t magic = ReadLe32(data + pos);
+
+            if ((magic & 0xFFFFFFF0u) == 0x184D2A50u) {
+                // Skippable frame
+                pos += 8 + (uint64_t)ReadLe32(data + pos + 4);
+            } else if (magic == ZSTD_FRAME_MAGIC) {
+                uint8_t descriptor = data[pos + 4];
+                if (descriptor & 0x08) return false;
+
+                static const int dictionaryIdSizes[] = {0, 1, 2, 4};
+                bool singleSegment = (descriptor >> 5) & 1;
+                int contentSizeFlag = descriptor >> 6;
+                int contentSizeBytes = contentSizeFlag == 0 ? (singleSegment ? 1 : 0) : (1 << contentSizeFlag);
+                pos += 5 + (singleSegment ? 0 : 1) + dictionaryIdSizes[descriptor & 3];
+                if (pos + contentSizeBytes > size) return false;
+
+                // Frame content size, only used to size buffers
+                for (int i = contentSizeBytes - 1; i >= 0; i--) {
+                    decodedSize = (decodedSize << 8) | data[pos + i];
+                }
+                if (contentSizeBytes == 2) decodedSize += 256;
+                pos += contentSizeBytes;
+
+                for (;;) {
+                    if (pos + 3 > size) return false;
+                    uint32_t header = data[pos] | (data[pos + 1] << 8) | (data[pos + 2] << 16);
+                    uint32_t blockType = (header >> 1) & 3;
+                    pos += 3;
+                    if (blockType == 3) return false;
+                    pos += blockType == 1 ? 1 : (header >> 3);
+                    if (pos > size) return false;
+                    if (header & 1) break;
+                }
+
+                if (descriptor & 0x04) pos += 4;   // Content checksum
+            } else {
+                return false;
+            }
+
+            if (pos > size) return false;
+            frames.push_back({start, pos - start, decodedSize});
+        }
+
+        GroupPieces(frames, targetChunkSize, [&](size_t first, size_t last) {
+            StreamChunk chunk;
+            chunk.data = data + frames[first].offset;
+            chunk.length = frames[last - 1].offset + frames[last - 1].length - frames[first].offset;
+            for (size_t i = first; i < last; i++) {
+                chunk.decodedSize += frames[i].decodedSize;
+            }
+            return chunk;
+        });
+        return true;
+    }
+
+    // ---- gzip: member boundaries are only known after decoding, so candidate headers
+    // are split on speculatively; a wrong guess makes a chunk fail and the caller
+    // falls back to the single-stream path ----
+
+    bool PlanGzip(uint64_t targetChunkSize) {
+        const uint8_t* data = input.Data();
+        uint64_t size = input.Size();
+        std::vector<Piece> members;
+
+        uint64_t start = 0;
+        const uint8_t* p = data + 1;
+        const uint8_t* end = data + size - 18;
+        while (p < end && (p = (const uint8_t*)memchr(p, 0x1F, end - p)) != nullptr) {
+            // ID1 ID2 CM, no reserved flags, sane XFL and OS bytes
+            if (p[1] == 0x8B && p[2] == 0x08 && !(p[3] & 0xE0) &&
+                (p[8] == 0 || p[8] == 2 || p[8] == 4) && (p[9] <= 13 || p[9] == 255)) {
+                uint64_t offset = p - data;
+                members.push_back({start, offset - start});
+                start = offset;
+            }
+            p++;
+        }
+        members.push_back({start, size - start});
+
+        GroupPieces(members, targetChunkSize, [&](size_t first, size_t last) {
+            StreamChunk chunk;
+            chunk.data = data + members[first].offset;
+            chunk.length = members[last - 1].offset + members[last - 1].length - members[first].offset;
+            return chunk;
+        });
+        return true;
+    }
+
+    // ---- bzip2: blocks start at arbitrary bit offsets, so every thread searches its
+    // slice for block/end-of-stream magics and the result is validated against the
+    // stored combined CRC before it is trusted ----
+
+    struct BitMark {
+        uint64_t bit;
+        bool endOfStream;
+    };
+
+    static uint64_t ReadBits(const uint8_t* data, uint64_t bit, int count) {
+        uint64_t value = 0;
+        for (int i = 0; i < count; i++, bit++) {
+            value = (value << 1) | ((data[bit >> 3] >> (7 - (bit & 7))) & 1);
+        }
+        return value;
+    }
+
+    void ScanBzip2Magics(uint64_t begin, uint64_t end, std::vector<BitMark>& marks) const {
+        const uint8_t* data = input.Data();
+        uint64_t size = input.Size();
+        const uint64_t mask = (1ull << 48) - 1;
+        uint64_t window = 0;
+
+        uint64_t last = std::min(end + 6, size);
+        for (uint64_t i = begin; i < last; i++) {
+            window = (window << 8) | data[i];
+            uint64_t bitsSeen = (i - begin + 1) * 8;
+            for (int shift = 7; shift >= 0; shift--) {
+                if (bitsSeen < 48u + shift) continue;
+
+                uint64_t candidate = (window >> shift) & mask;
+                if (candidate != BZIP2_BLOCK_MAGIC && candidate != BZIP2_END_MAGIC) continue;
+
+                uint64_t startBit = (i + 1) * 8 - shift - 48;
+                if (startBit >= begin * 8 && startBit < end * 8) {
+                    marks.push_back({startBit, candidate == BZIP2_END_MAGIC});
+                }
+            }
+        }
+    }
+
+    bool PlanBzip2(uint64_t targetChunkSize, unsigned threads) {
+        const uint8_t* data = input.Data();
+        uint64_t size = input.Size();
+
+        size_t sliceCount = std::max(threads, 1u);
+        uint64_t sliceSize = (size + sliceCount - 1) / sliceCount;
+        std::vector<std::vector<BitMark>> sliceMarks(sliceCount);
+        std::vector<std::thread> scanners;
+        for (size_t i = 0; i < sliceCount; i++) {
+            uint64_t begin = std::min<uint64_t>(i * sliceSize, size);
+            uint64_t end = std::min<uint64_t>(begin + sliceSize, size);
+            scanners.emplace_back([this, begin, end, &sliceMarks, i]() {
+                ScanBzip2Magics(begin, end, sliceMarks[i]);
+            });
+        }
+        for (auto& thread : scanners) {
+            thread.join();
+        }
+
+        std::vector<BitMark> marks;
+        for (auto& slice : sliceMarks) {
+            marks.insert(marks.end(), slice.begin(), slice.end());
+        }
+
+        // Walk the streams (pbzip2 writes one per block) and check each stream's
+        // combined CRC, which also rejects magics that were really compressed data
+        std::vector<Bzip2Block> blocks;
+        uint64_t streamByte = 0;
+        size_t m = 0;
+        while (streamByte < size) {
+            if (size - streamByte < 14 || memcmp(data + streamByte, "BZh", 3) != 0 ||
+                data[streamByte + 3] < '1' || data[streamByte + 3] > '9') {
+                return false;
+            }
+
+            uint64_t expectedBit = (streamByte + 4) * 8;
+            uint32_t combinedCrc = 0;
+            for (;;) {
+                while (m < marks.size() && marks[m].bit < expectedBit) m++;
+                if (m >= marks.size() || marks[m].bit != expectedBit) return false;
+
+                if (marks[m].endOfStream) {
+                    if (expectedBit + 80 > size * 8 || ReadBits(data, expectedBit + 48, 32) != combinedCrc) {
+                        return false;
+                    }
+                    streamByte = (expectedBit + 80 + 7) / 8;
+                    m++;
+                    break;
+                }
+
+                if (m + 1 >= marks.size()) return false;
+                Bzip2Block block;
+                block.startBit = marks[m].bit;
+                block.endBit = marks[m + 1].bit;
+                block.crc = (uint32_t)ReadBits(data, block.startBit + 48, 32);
+                block.length = (block.endBit - block.startBit) / 8;
+                combinedCrc = ((combinedCrc << 1) | (combinedCrc >> 31)) ^ block.crc;
+                blocks.push_back(block);
+
+                expectedBit = block.endBit;
+                m++;
+            }
+        }
+
+        if (blocks.empty()) return false;
+
+        GroupPieces(blocks, targetChunkSize, [&](size_t first, size_t last) {
+            StreamChunk chunk;
+            chunk.data = data;
+            chunk.bzip2Blocks.assign(blocks.begin() + first, blocks.begin() + last);
+            return chunk;
+        });
+        return true;
+    }
+
+    struct BitWriter {
+        std::vector<uint8_t>& out;
+        uint64_t accumulator = 0;
+        int pending = 0;
+
+        explicit BitWriter(std::vector<uint8_t>& out) : out(out) {}
+
+        void Write(uint64_t value, int count) {
+            for (int i = count - 1; i >= 0; i--) {
+                accumulator = (accumulator << 1) | ((value >> i) & 1);
+                if (++pending == 8) {
+                    out.push_back((uint8_t)accumulator);
+                    accumulator = 0;
+                    pending = 0;
+                }
+            }
+        }
+
+        void WriteByte(uint8_t value) {
+            if (pending == 0) {
+                out.push_back(value);
+            } else {
+                accumulator = (accumulator << 8) | value;
+                out.push_back((uint8_t)(accumulator >> pending));
+                accumulator &= (1u << pending) - 1;
+            }
+        }
+
+        void Flush() {
+            if (pending > 0) {
+                out.push_back((uint8_t)(accumulator << (8 - pending)));
+                accumulator = 0;
+                pending = 0;
+            }
+        }
+    };
+
+    static void CopyBits(const uint8_t* data, BitWriter& writer, uint64_t startBit, uint64_t endBit) {
+        uint64_t bit = startBit;
+        int shift = (int)(bit & 7);
+
+        while (bit + 8 <= endBit) {
+            uint64_t byteIndex = bit >> 3;
+            uint8_t value = shift == 0
+                ? data[byteIndex]
+                : (uint8_t)((data[byteIndex] << shift) | (data[byteIndex + 1] >> (8 - shift)));
+            writer.WriteByte(value);
+            bit += 8;
+        }
+        if (bit < endBit) {
+            writer.Write(ReadBits(data, bit, (int)(endBit - bit)), (int)(endBit - bit));
+        }
+    }
+
+    // ---- decoding ----
+
+    // Streams the decoder's stdout into sink; a false return from sink stops the decoder, as
+    // does running longer than timeoutMs (reported through timedOut)
+    template <typename Sink>
+    static bool RunDecoder(const std::string& command, const StreamChunk& chunk, DWORD timeoutMs,
+                           bool& timedOut, Sink sink) {
+        // Serialise pipe creation and CreateProcess so one decoder never inherits
+        // another decoder's pipe ends and keeps them open
+        static std::mutex spawnMutex;
+
+        HANDLE hStdinRead, hStdinWrite, hStdoutRead, hStdoutWrite;
+        PROCESS_INFORMATION pi;
+        {
+            std::lock_guard<std::mutex> lock(spawnMutex);
+
+            SECURITY_ATTRIBUTES sa = {sizeof(sa), NULL, TRUE};
+            if (!CreatePipe(&hStdinRead, &hStdinWrite, &sa, 1 << 20)) {
+                return false;
+            }
+            if (!CreatePipe(&hStdoutRead, &hStdoutWrite, &sa, 1 << 20)) {
+                CloseHandle(hStdinRead);
+                CloseHandle(hStdinWrite);
+                return false;
+            }
+            SetHandleInformation(hStdinWrite, HANDLE_FLAG_INHERIT, 0);
+            SetHandleInformation(hStdoutRead, HANDLE_FLAG_INHERIT, 0);
+            HANDLE hNul = CreateFileA("NUL", GENERIC_WRITE, FILE_SHARE_READ | FILE_SHARE_WRITE,
+                                      &sa, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+
+            STARTUPINFOA si = {sizeof(si)};
+            si.dwFlags = STARTF_USESHOWWINDOW | STARTF_USESTDHANDLES;
+            si.wShowWindow = SW_HIDE;
+            si.hStdInput = hStdinRead;
+            si.hStdOutput = hStdoutWrite;
+            si.hStdError = hNul;
+
+            std::string commandLine = command;
+            BOOL started = CreateProcessA(NULL, &commandLine[0], NULL, NULL, TRUE,
+                                          CREATE_NO_WINDOW, NULL, NULL, &si, &pi);
+
+            CloseHandle(hStdinRead);
+            CloseHandle(hStdoutWrite);
+            if (hNul != INVALID_HANDLE_VALUE) CloseHandle(hNul);
+
+            if (!started) {
+                CloseHandle(hStdinWrite);
+                CloseHandle(hStdoutRead);
+                return false;
+            }
+        }
+
+        // Killing a hung decoder closes its pipes, which ends the reads below
+        timedOut = false;
+        std::thread watchdog([&]() {
+            if (WaitForSingleObject(pi.hProcess, timeoutMs) == WAIT_TIMEOUT) {
+                timedOut = true;
+                TerminateProcess(pi.hProcess, 1);
+            }
+        });
+
+        // Feed stdin from another thread so a full stdout pipe cannot deadlock us
+        std::exception_ptr feedError;
+        std::thread feeder([&]() {
+            auto feed = [&](const uint8_t* data, uint64_t length) {
+                while (length > 0) {
+                    DWORD toWrite = (DWORD)std::min<uint64_t>(length, 1 << 20);
+                    DWORD written = 0;
+                    if (!WriteFile(hStdinWrite, data, toWrite, &written, NULL) || written == 0) return false;
+                    data += written;
+                    length -= written;
+                }
+                return true;
+            };
+
+            // Re-packs the chunk's bzip2 blocks into a new "BZh9" stream, passing it on
+            // about a block at a time
+            auto feedBzip2 = [&]() {
+                std::vector<uint8_t> packed;
+                packed.reserve(2 << 20);
+                BitWriter writer(packed);
+                writer.Write(0x425A6839, 32);
+
+                uint32_t combinedCrc = 0;
+                for (const Bzip2Block& block : chunk.bzip2Blocks) {
+                    CopyBits(chunk.data, writer, block.startBit, block.endBit);
+                    combinedCrc = ((combinedCrc << 1) | (combinedCrc >> 31)) ^ block.crc;
+                    if (packed.size() >= (1 << 20)) {
+                        if (!feed(packed.data(), packed.size())) return false;
+                        packed.clear();
+                    }
+                }
+                writer.Write(BZIP2_END_MAGIC, 48);
+                writer.Write(combinedCrc, 32);
+                writer.Flush();
+                return feed(packed.data(), packed.size());
+            };
+
+            try {
+                feed(chunk.prefix.data(), chunk.prefix.size()) &&
+                    (chunk.bzip2Blocks.empty() ? feed(chunk.data, chunk.length) : feedBzip2()) &&
+                    feed(chunk.suffix.data(), chunk.suffix.size());
+            } catch (...) {
+                // The decoder sees a truncated stream; rethrown once everything is cleaned up
+                feedError = std::current_exception();
+            }
+            CloseHandle(hStdinWrite);
+        });
+
+        char buffer[64 * 1024];
+        DWORD bytesRead = 0;
+        bool accepted = true;
+        std::exception_ptr sinkError;
+        while (ReadFile(hStdoutRead, buffer, sizeof(buffer), &bytesRead, NULL) && bytesRead > 0) {
+            try {
+                accepted = sink((const uint8_t*)buffer, bytesRead);
+            } catch (...) {
+                // Rethrown once the feeder thread and handles are cleaned up
+                sinkError = std::current_exception();
+                accepted = false;
+            }
+            if (!accepted) {
+                TerminateProcess(pi.hProcess, 1);
+                break;
+            }
+        }
+
+        feeder.join();
+        watchdog.join();
+        WaitForSingleObject(pi.hProcess, INFINITE);
+
+        DWORD exitCode = 1;
+        GetExitCodeProcess(pi.hProcess, &exitCode);
+        CloseHandle(hStdoutRead);
+        CloseHandle(pi.hProcess);
+        CloseHandle(pi.hThread);
+
+        if (sinkError) {
+            std::rethrow_exception(sinkError);
+        }
+        if (feedError) {
+            std::rethrow_exception(feedError);
+        }
+        return accepted && !timedOut && exitCode == 0;
+    }
+};
+
+// Decides from a file name alone whether a notification is an archive. Everything here
+// runs for every file that lands in Downloads, so none of it allocates once eventName-style
+// buffers have grown to the longest name seen (see tests/EventPathAllocationTest.cpp).
+class ArchiveNameFilter {
+public:
+    // Converts into a caller-owned buffer; once it has grown to the longest name seen,
+    // conversions no longer allocate
+    static void WStringToString(const WCHAR* wstr, size_t length, std::string& result) {
+        int size = length ? WideCharToMultiByte(CP_UTF8, 0, wstr, (int)length, NULL, 0, NULL, NULL) : 0;
+        result.resize(size);
+        if (size > 0) {
+            WideCharToMultiByte(CP_UTF8, 0, wstr, (int)length, &result[0], size, NULL, NULL);
+        }
+    }
+
+    static bool EndsWithNoCase(std::string_view text, std::string_view lowerSuffix) {
+        if (lowerSuffix.size() > text.size()) return false;
+        return std::equal(lowerSuffix.begin(), lowerSuffix.end(), text.end() - lowerSuffix.size(),
+                          [](char suffixChar, char textChar) {
+                              return suffixChar == (char)::tolower((unsigned char)textChar);
+                          });
+    }
+
+    bool IsArchive(std::string_view filename) const {
+        for (const auto& ext : supportedExtensions) {
+            if (EndsWithNoCase(filename, ext)) {
+                return true;
+            }
+        }
+
+        // Check for numbered extensions (.001, .002, etc.)
+        size_t n = filename.size();
+        return n >= 4 && filename[n - 4] == '.' &&
+               isdigit((unsigned char)filename[n - 3]) &&
+               isdigit((unsigned char)filename[n - 2]) &&
+               isdigit((unsigned char)filename[n - 1]);
+    }
+
+    bool IsConventional(std::string_view filename) const {
+        for (const auto& ext : conventionalExtensions) {
+            if (EndsWithNoCase(filename, ext)) {
+                return true;
+            }
+        }
+        return false;
+    }
 
-// Enhanced AutoUnzipService class with better error handling and 2FA support
-class AutoUnzipService {
 private:
-    HWND hWnd;
-    NOTIFYICONDATA nid;
-    HANDLE hDirectoryWatcher;
-    std::atomic<bool> isRunning{true};
-    std::atomic<bool> isPaused{false};
-    std::mutex processingMutex;
-    std::string peazipPath;
-    std::string downloadsPath;
-    std::map<std::string, int> passwordAttempts;
-    
     // Enhanced supported extensions with better categorization
     std::vector<std::string> supportedExtensions = {
         // Common archives
-        ".7z", ".zip", ".rar", ".tar", ".gz", ".bz2", ".xz", 
+        ".7z", ".zip", ".rar", ".tar", ".gz", ".bz2", ".xz", ".zst",
         // Disk images
         ".iso", ".img", ".dmg", ".vhd", ".vmdk",
         // Legacy formats
-        ".cab", ".arj", ".lzh", ".ace", ".uue", ".z", 
+        ".cab", ".arj", ".lzh", ".ace", ".uue", ".z",
         // Compressed tars
-        ".taz", ".tbz", ".tbz2", ".txz", ".tlz",
+        ".taz", ".tbz", ".tbz2", ".txz", ".tlz", ".tzst",
         // Application packages
         ".war", ".jar", ".ear", ".sar", ".apk", ".ipa",
         // Split archives
@@ -60,14 +2331,180 @@ private:
         // Backup formats
         ".bak", ".backup", ".arc"
     };
-    
+
     std::vector<std::string> conventionalExtensions = {
         ".zip", ".rar", ".7z", ".tar", ".gz", ".bz2"
     };
+};
+
+// Runs delayed retries from a shared Win32 timer queue, so a pending retry holds no
+// thread while it waits. Delays double per attempt, with random jitter.
+class RetryScheduler {
+public:
+    struct Metrics {
+        std::atomic<uint32_t> scheduled{0};
+        std::atomic<uint32_t> succeeded{0};
+        std::atomic<uint32_t> exhausted{0};
+        std::atomic<uint32_t> failures[(size_t)ExtractionFailure::Unknown + 1]{};
+    };
+
+    ~RetryScheduler() {
+        Shutdown();
+    }
+
+    // baseDelayMs of 0 disables retries
+    bool Start(DWORD baseDelayMs, unsigned maxRetries) {
+        this->baseDelayMs = baseDelayMs;
+        this->maxRetries = maxRetries;
+        if (baseDelayMs == 0 || maxRetries == 0) return true;
+
+        std::lock_guard<std::mutex> lock(mutex);
+        queue = CreateTimerQueue();
+        return queue != NULL;
+    }
+
+    // Waits for retries that are already running; ones still waiting are dropped
+    void Shutdown() {
+        HANDLE oldQueue;
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            oldQueue = queue;
+            queue = NULL;
+        }
+        if (!oldQueue) return;
+
+        DeleteTimerQueueEx(oldQueue, INVALID_HANDLE_VALUE);
+
+        std::lock_guard<std::mutex> lock(mutex);
+        for (Pending* entry : pending) {
+            delete entry;
+        }
+        pending.clear();
+    }
+
+    // Schedules retry number `attempt` (1-based). Returns false when retries are disabled
+    // or the attempt limit is reached; delayMs receives the chosen delay.
+    bool Schedule(unsigned attempt, std::function<void()> action, DWORD& delayMs) {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (!queue) return false;
+        if (attempt > maxRetries) {
+            metrics.exhausted++;
+            return false;
+        }
+
+        // Keep at least half of the exponential delay and randomise the rest, so archives
+        // that failed together do not all retry in the same instant
+        uint64_t delay = std::min<uint64_t>((uint64_t)baseDelayMs << std::min(attempt - 1, 16u), MAX_RETRY_DELAY_MS);
+        std::uniform_int_distribution<uint64_t> jitter(0, delay / 2);
+        delayMs = (DWORD)(delay - delay / 2 + jitter(rng));
+
+        Pending* entry = new Pending{this, NULL, std::move(action)};
+        if (!CreateTimerQueueTimer(&entry->timer, queue, OnTimer, entry, delayMs, 0,
+                                   WT_EXECUTEONLYONCE | WT_EXECUTELONGFUNCTION)) {
+            delete entry;
+            return false;
+        }
+        pending.insert(entry);
+        metrics.scheduled++;
+        return true;
+    }
+
+    Metrics& Stats() { return metrics; }
+
+    std::string Summary() {
+        std::string summary = "Retries: " + std::to_string(metrics.scheduled) + " scheduled, " +
+                              std::to_string(metrics.succeeded) + " succeeded, " +
+                              std::to_string(metrics.exhausted) + " gave up";
+
+        std::string failures;
+        for (size_t i = 0; i <= (size_t)ExtractionFailure::Unknown; i++) {
+            uint32_t count = metrics.failures[i];
+            if (count == 0) continue;
+            if (!failures.empty()) failures += ", ";
+            failures += std::string(FailureReasonName((ExtractionFailure)i)) + " " + std::to_string(count);
+        }
+        return summary + "\nFailures: " + (failures.empty() ? "none" : failures);
+    }
+
+private:
+    struct Pending {
+        RetryScheduler* owner;
+        HANDLE timer;
+        std::function<void()> action;
+    };
+
+    static void CALLBACK OnTimer(void* context, BOOLEAN) {
+        Pending* entry = static_cast<Pending*>(context);
+        RetryScheduler* owner = entry->owner;
+        {
+            // The lock also orders this against CreateTimerQueueTimer storing entry->timer.
+            // During shutdown the entry is left for Shutdown to free.
+            std::lock_guard<std::mutex> lock(owner->mutex);
+            if (!owner->queue) return;
+            owner->pending.erase(entry);
+            DeleteTimerQueueTimer(owner->queue, entry->timer, NULL);
+        }
+
+        entry->action();
+        delete entry;
+    }
+
+    std::mutex mutex;
+    HANDLE queue = NULL;
+    std::set<Pending*> pending;
+    DWORD baseDelayMs = 0;
+    unsigned maxRetries = 0;
+    std::mt19937 rng{std::random_device{}()};
+    Metrics metrics;
+};
+
+// Enhanced AutoUnzipService class with better error handling and 2FA support
+class AutoUnzipService {
+private:
+    HWND hWnd;
+    NOTIFYICONDATA nid;
+    HANDLE hDirectoryWatcher;
+    std::atomic<bool> isRunning{true};
+    std::atomic<bool> isPaused{false};
+    std::timed_mutex processingMutex;
+    std::string peazipPath;
+    std::string sevenZipPath;
+    std::string zstdPath;
+    std::string downloadsPath;
+    unsigned decoderThreads = 0;
+    std::string configPath;
+    std::string logPath = GetModuleDirectory() + "\\AutoUnzipService.log";
+    
+    // Event path scratch buffer, reused so steady-state notifications do not allocate
+    std::string eventName;
+    
+    // First block of every job arena; jobs run one at a time under processingMutex
+    alignas(std::max_align_t) char jobArenaBuffer[JOB_ARENA_SIZE];
+    
+    // [Performance] MemoryLimitMB for the service's own footprint (0 = no limit), enforced
+    // through memoryJob; extraction processes break away from the job and are not counted
+    unsigned memoryLimitMB = 0;
+    HANDLE memoryJob = NULL;
+    
+    // [Advanced] RetryDelay / MaxRetries for transient extraction failures
+    unsigned retryDelaySeconds = 0;
+    unsigned maxRetries = 3;
+    RetryScheduler retryScheduler;
+    
+    // [Logging] tracing options
+    bool tracingEnabled = false;
+    std::string traceFilePath;
+    
+    ArchiveNameFilter nameFilter;
 
 public:
     AutoUnzipService() {
         CoInitialize(NULL);
+        eventName.reserve(MAX_PATH * 4);
+        LoadConfiguration();
+        if (!retryScheduler.Start(retryDelaySeconds * 1000, maxRetries)) {
+            LogEvent("Failed to create retry timer queue, failed extractions will not be retried");
+        }
         InitializePaths();
         CreateTrayIcon();
         StartDirectoryWatcher();
@@ -79,6 +2516,80 @@ public:
         CoUninitialize();
     }
     
+    std::string GetModuleDirectory() {
+        char currentDir[MAX_PATH];
+        GetModuleFileNameA(NULL, currentDir, MAX_PATH);
+        std::string currentDirStr(currentDir);
+        return currentDirStr.substr(0, currentDirStr.find_last_of("\\/"));
+    }
+    
+    std::string ReadConfigString(const char* section, const char* key, const char* defaultValue) {
+        char buffer[MAX_PATH];
+        GetPrivateProfileStringA(section, key, defaultValue, buffer, sizeof(buffer), configPath.c_str());
+        return buffer;
+    }
+    
+    bool ReadConfigBool(const char* section, const char* key, bool defaultValue) {
+        std::string value = ReadConfigString(section, key, defaultValue ? "true" : "false");
+        std::transform(value.begin(), value.end(), value.begin(), ::tolower);
+        return value == "true" || value == "1" || value == "yes";
+    }
+    
+    void LoadConfiguration() {
+        // config.ini sits next to the executable; missing keys keep their defaults
+        configPath = GetModuleDirectory() + "\\config.ini";
+        
+        tracingEnabled = ReadConfigBool("Logging", "EnableTracing", false);
+        traceFilePath = ReadConfigString("Logging", "TraceFile", "");
+        if (traceFilePath.empty()) {
+            traceFilePath = GetModuleDirectory() + "\\AutoUnzipService.trace.json";
+        }
+        
+        sevenZipPath = ReadConfigString("Paths", "SevenZipPath", "");
+        zstdPath = ReadConfigString("Paths", "ZstdPath", "");
+        decoderThreads = GetPrivateProfileIntA("Performance", "DecoderThreads", 0, configPath.c_str());
+        memoryLimitMB = GetPrivateProfileIntA("Performance", "MemoryLimitMB", 0, configPath.c_str());
+        retryDelaySeconds = GetPrivateProfileIntA("Advanced", "RetryDelay", 0, configPath.c_str());
+        maxRetries = GetPrivateProfileIntA("Advanced", "MaxRetries", 3, configPath.c_str());
+        
+        if (tracingEnabled) {
+            if (TraceRecorder::Instance().Enable(traceFilePath)) {
+                LogEvent("Tracing enabled, writing spans to: " + traceFilePath);
+            } else {
+                LogEvent("Failed to open trace file: " + traceFilePath);
+            }
+        }
+        
+        if (memoryLimitMB > 0) {
+            ApplyMemoryLimit();
+        }
+    }
+    
+    // Caps the committed memory of this process at MemoryLimitMB with a job object;
+    // allocations past it fail (std::bad_alloc) instead of growing the service further
+    void ApplyMemoryLimit() {
+        memoryJob = CreateJobObjectA(NULL, NULL);
+        if (!memoryJob) {
+            LogEvent("Failed to create job object, MemoryLimitMB is not enforced (error " +
+                     std::to_string(GetLastError()) + ")");
+            return;
+        }
+        
+        // Children (7-Zip, zstd, PeaZip) leave the job silently so the limit only covers the service
+        JOBOBJECT_EXTENDED_LIMIT_INFORMATION limits = {};
+        limits.BasicLimitInformation.LimitFlags = JOB_OBJECT_LIMIT_PROCESS_MEMORY | JOB_OBJECT_LIMIT_SILENT_BREAKAWAY_OK;
+        limits.ProcessMemoryLimit = (SIZE_T)memoryLimitMB << 20;
+        if (!SetInformationJobObject(memoryJob, JobObjectExtendedLimitInformation, &limits, sizeof(limits)) ||
+            !AssignProcessToJobObject(memoryJob, GetCurrentProcess())) {
+            LogEvent("Failed to apply MemoryLimitMB, the limit is not enforced (error " +
+                     std::to_string(GetLastError()) + ")");
+            CloseHandle(memoryJob);
+            memoryJob = NULL;
+            return;
+        }
+        LogEvent("Memory limit set to " + std::to_string(memoryLimitMB) + " MB");
+    }
+    
     void InitializePaths() {
         // Enhanced PeaZip detection with multiple registry locations
         std::vector<std::string> registryPaths = {
@@ -126,6 +2637,17 @@ public:
             }
         }
         
+        // Locate the 7-Zip engine so archives skip the PeaZip front-end
+        if (sevenZipPath.empty() || !std::filesystem::exists(sevenZipPath)) {
+            sevenZipPath = SevenZipEngine::Locate(peazipPath);
+        }
+        
+        // 7-Zip has no zstd codec; PeaZip bundles the reference zstd binary
+        if ((zstdPath.empty() || !std::filesystem::exists(zstdPath)) && !peazipPath.empty()) {
+            std::string bundledZstd = peazipPath.substr(0, peazipPath.find_last_of("\\/")) + "\\res\\bin\\zstd\\zstd.exe";
+            zstdPath = std::filesystem::exists(bundledZstd) ? bundledZstd : "";
+        }
+        
         // Get Downloads folder with fallback
         char downloadsBuffer[MAX_PATH];
         if (SHGetFolderPathA(NULL, CSIDL_PROFILE, NULL, SHGFP_TYPE_CURRENT, downloadsBuffer) == S_OK) {
@@ -186,6 +2708,7 @@ public:
             overlapped.hEvent = CreateEvent(NULL, FALSE, FALSE, NULL);
             
             LogEvent("Started monitoring: " + downloadsPath);
+            TraceRecorder::Instance().NameCurrentThread("Directory watcher");
             
             while (isRunning) {
                 if (ReadDirectoryChangesW(
@@ -216,22 +2739,47 @@ public:
     }
     
     void ProcessDirectoryChanges(char* buffer, DWORD bytesReturned) {
-        std::lock_guard<std::mutex> lock(processingMutex);
+        // The wait is charged to the first archive job of this batch; a batch without
+        // archives records it outside any job
+        TraceSpan queueSpan("queue wait");
+        std::lock_guard<std::timed_mutex> lock(processingMutex);
+        queueSpan.Stop();
         
         FILE_NOTIFY_INFORMATION* pNotify = (FILE_NOTIFY_INFORMATION*)buffer;
         
         do {
             if (pNotify->Action == FILE_ACTION_ADDED || pNotify->Action == FILE_ACTION_RENAMED_NEW_NAME) {
-                std::wstring filename(pNotify->FileName, pNotify->FileNameLength / sizeof(WCHAR));
-                std::string filenameStr = WStringToString(filename);
+                // Name conversion and classification reuse eventName, so the
+                // notifications that are not archives never touch the heap
+                TraceSpan notifySpan("notify");
+                ArchiveNameFilter::WStringToString(pNotify->FileName, pNotify->FileNameLength / sizeof(WCHAR), eventName);
+                notifySpan.Stop();
                 
-                std::string fullPath = downloadsPath + "\\" + filenameStr;
+                // Classify by name first so only archives pay for the stability wait
+                TraceSpan classifySpan("classify");
+                bool isArchive = nameFilter.IsArchive(eventName);
+                classifySpan.Stop();
                 
-                // Wait for file to be completely written and stable
-                if (WaitForFileStable(fullPath)) {
-                    if (IsArchiveFile(filenameStr)) {
-                        LogEvent("Detected archive: " + filenameStr);
-                        ProcessArchiveFile(fullPath, filenameStr);
+                if (isArchive) {
+                    // All job state lives in this arena and is released in one go when the job ends
+                    std::pmr::monotonic_buffer_resource arena(jobArenaBuffer, sizeof(jobArenaBuffer));
+                    ArchiveJob job(&arena);
+                    job.filename = eventName;
+                    job.filePath.append(downloadsPath).append("\\").append(eventName);
+                    TraceJobScope jobScope(eventName);
+                    queueSpan.End();
+                    notifySpan.End();
+                    classifySpan.End();
+                    
+                    // Wait for file to be completely written and stable
+                    TraceSpan stableSpan("stability wait");
+                    bool stable = WaitForFileStable(job.filePath.c_str());
+                    stableSpan.End();
+                    
+                    if (stable) {
+                        job.message.assign("Detected archive: ").append(job.filename);
+                        LogEvent(job.message);
+                        ProcessArchiveFile(job);
                     }
                 }
             }
@@ -242,20 +2790,12 @@ public:
         } while (true);
     }
     
-    std::string WStringToString(const std::wstring& wstr) {
-        if (wstr.empty()) return std::string();
-        int size = WideCharToMultiByte(CP_UTF8, 0, &wstr[0], (int)wstr.size(), NULL, 0, NULL, NULL);
-        std::string result(size, 0);
-        WideCharToMultiByte(CP_UTF8, 0, &wstr[0], (int)wstr.size(), &result[0], size, NULL, NULL);
-        return result;
-    }
-    
-    bool WaitForFileStable(const std::string& filePath) {
+    bool WaitForFileStable(const char* filePath) {
         // Wait for file to be stable (not being written to)
         for (int i = 0; i < 10; i++) {
             std::this_thread::sleep_for(std::chrono::seconds(1));
             
-            HANDLE hFile = CreateFileA(filePath.c_str(), GENERIC_READ, FILE_SHARE_READ, 
+            HANDLE hFile = CreateFileA(filePath, GENERIC_READ, FILE_SHARE_READ, 
                                       NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
             if (hFile != INVALID_HANDLE_VALUE) {
                 CloseHandle(hFile);
@@ -265,63 +2805,126 @@ public:
         return false;
     }
     
-    bool IsArchiveFile(const std::string& filename) {
-        std::string lowerFilename = filename;
-        std::transform(lowerFilename.begin(), lowerFilename.end(), lowerFilename.begin(), ::tolower);
-        
-        for (const auto& ext : supportedExtensions) {
-            if (lowerFilename.ends_with(ext)) {
-                return true;
-            }
-        }
-        
-        // Check for numbered extensions (.001, .002, etc.)
-        std::regex numberedPattern(R"(\.(\d{3})$)");
-        return std::regex_search(lowerFilename, numberedPattern);
-    }
-    
-    bool IsConventionalArchive(const std::string& filename) {
-        std::string lowerFilename = filename;
-        std::transform(lowerFilename.begin(), lowerFilename.end(), lowerFilename.begin(), ::tolower);
+    // Per-archive state, allocated from the job's arena
+    struct ArchiveJob {
+        explicit ArchiveJob(std::pmr::memory_resource* arena)
+            : filePath(arena), filename(arena), message(arena) {}
         
-        for (const auto& ext : conventionalExtensions) {
-            if (lowerFilename.ends_with(ext)) {
-                return true;
-            }
-        }
-        return false;
-    }
+        std::pmr::string filePath;
+        std::pmr::string filename;
+        std::pmr::string message;   // Scratch space for prompts and log lines
+        int passwordAttempts = 0;
+        unsigned attempt = 0;       // Retries already made after transient failures
+    };
     
-    void ProcessArchiveFile(const std::string& filePath, const std::string& filename) {
-        // For non-conventional archives, prompt user
-        if (!IsConventionalArchive(filename)) {
-            std::string message = "Do you want to extract the archive: " + filename + "?\n\n"
-                                "File path: " + filePath + "\n"
-                                "This is a non-standard archive format.";
+    void ProcessArchiveFile(ArchiveJob& job) {
+        // For non-conventional archives, prompt user (retries were already confirmed)
+        if (job.attempt == 0 && !nameFilter.IsConventional(job.filename)) {
+            job.message.assign("Do you want to extract the archive: ").append(job.filename)
+                       .append("?\n\nFile path: ").append(job.filePath)
+                       .append("\nThis is a non-standard archive format.");
             
-            int result = MessageBoxA(NULL, message.c_str(),
+            int result = MessageBoxA(NULL, job.message.c_str(),
                                    "Auto Unzip - Confirmation Required",
                                    MB_YESNO | MB_ICONQUESTION | MB_TOPMOST);
             
             if (result != IDYES) {
-                LogEvent("User declined to extract: " + filename);
+                job.message.assign("User declined to extract: ").append(job.filename);
+                LogEvent(job.message);
                 return;
             }
         }
         
-        // Reset password attempts for new file
-        passwordAttempts[filename] = 0;
+        // Extraction backends build their own command lines from a plain string
+        const std::string filePath(job.filePath);
         
         // Try to extract without password first
-        if (!ExtractArchive(filePath, "", "")) {
-            // If failed, prompt for password
-            PasswordDialogData data = PromptForPassword(filename);
+        ExtractionFailure failure = ExtractionFailure::Unknown;
+        bool extracted = false;
+        try {
+            extracted = ExtractArchive(filePath, "", "", &failure);
+        } catch (const std::bad_alloc&) {
+            // MemoryLimitMB is a hard cap; running into it fails this job, not the service
+            failure = ExtractionFailure::OutOfMemory;
+        }
+        if (extracted) {
+            if (job.attempt > 0) retryScheduler.Stats().succeeded++;
+        } else {
+            retryScheduler.Stats().failures[(size_t)failure]++;
+            
+            if (IsTransientFailure(failure) && ScheduleRetry(job, failure)) {
+                return;
+            }
+            
+            // Only prompt when the backend could not rule out a missing password. Retries run on
+            // a timer-queue thread, where a modal dialog would hold up shutdown, so they never do.
+            if (job.attempt > 0 ||
+                (failure != ExtractionFailure::WrongPassword && failure != ExtractionFailure::Unknown)) {
+                job.message.assign("Could not extract ").append(job.filename).append(": ").append(FailureReasonName(failure));
+                ShowTrayNotification("Auto Unzip - Error", job.message.c_str());
+                return;
+            }
+            
+            PasswordDialogData data = PromptForPassword(job);
             if (!data.cancelled && !data.password.empty()) {
                 ExtractArchive(filePath, data.password, data.twoFactorCode);
             }
         }
     }
     
+    // Queues the job again after a transient failure. Only password-less attempts are
+    // retried, since passwords are never kept after the dialog closes.
+    bool ScheduleRetry(const ArchiveJob& job, ExtractionFailure failure) {
+        unsigned attempt = job.attempt + 1;
+        std::string filePath(job.filePath);
+        std::string filename(job.filename);
+        
+        DWORD delayMs = 0;
+        bool scheduled = retryScheduler.Schedule(attempt, [this, filePath, filename, attempt]() {
+            RetryArchive(filePath, filename, attempt);
+        }, delayMs);
+        
+        if (scheduled) {
+            LogEvent("Extraction of " + filename + " failed (" + FailureReasonName(failure) + "), retry " +
+                     std::to_string(attempt) + " of " + std::to_string(maxRetries) + " in " +
+                     std::to_string(delayMs / 1000) + " s");
+        } else if (job.attempt > 0) {
+            LogEvent("Giving up on " + filename + " after " + std::to_string(job.attempt) + " retries");
+        }
+        return scheduled;
+    }
+    
+    // Runs on a timer-queue thread once a retry's delay has elapsed
+    void RetryArchive(const std::string& filePath, const std::string& filename, unsigned attempt) {
+        if (!isRunning) return;
+        
+        // The job is known up front here, so the queue wait belongs to it too
+        TraceJobScope jobScope(filename);
+        TraceSpan queueSpan("queue wait");
+        // Cleanup waits for this callback, so stop queueing behind a long extraction
+        // once it has begun, and do not start one either
+        std::unique_lock<std::timed_mutex> lock(processingMutex, std::defer_lock);
+        while (!lock.try_lock_for(std::chrono::milliseconds(200))) {
+            if (!isRunning) return;
+        }
+        queueSpan.End();
+        if (!isRunning) return;
+        
+        if (GetFileAttributesA(filePath.c_str()) == INVALID_FILE_ATTRIBUTES) {
+            LogEvent("Archive removed before retry: " + filePath);
+            return;
+        }
+        
+        std::pmr::monotonic_buffer_resource arena(jobArenaBuffer, sizeof(jobArenaBuffer));
+        ArchiveJob job(&arena);
+        job.filePath = filePath;
+        job.filename = filename;
+        job.attempt = attempt;
+        
+        LogEvent("Retrying extraction of " + filename + " (attempt " + std::to_string(attempt) + ")");
+        ProcessArchiveFile(job);
+    }
+    
     struct PasswordDialogData {
         std::string filename;
         std::string password;
@@ -329,21 +2932,22 @@ public:
         bool cancelled = false;
     };
     
-    PasswordDialogData PromptForPassword(const std::string& filename) {
+    PasswordDialogData PromptForPassword(ArchiveJob& job) {
         PasswordDialogData data;
-        data.filename = filename;
+        data.filename = job.filename;
         
         // Check if we've exceeded maximum attempts
-        if (passwordAttempts[filename] >= MAX_PASSWORD_ATTEMPTS) {
+        if (job.passwordAttempts >= MAX_PASSWORD_ATTEMPTS) {
+            job.message.assign("Maximum password attempts exceeded for: ").append(job.filename);
             MessageBoxA(NULL, 
-                       ("Maximum password attempts exceeded for: " + filename).c_str(),
+                       job.message.c_str(),
                        "Auto Unzip - Error", 
                        MB_OK | MB_ICONERROR | MB_TOPMOST);
             data.cancelled = true;
             return data;
         }
         
-        passwordAttempts[filename]++;
+        job.passwordAttempts++;
         
         INT_PTR result = DialogBoxParam(
             GetModuleHandle(NULL),
@@ -356,16 +2960,43 @@ public:
         return data;
     }
     
-    bool ExtractArchive(const std::string& archivePath, const std::string& password, const std::string& twoFactorCode) {
+    bool ExtractArchive(const std::string& archivePath, const std::string& password, const std::string& twoFactorCode,
+                        ExtractionFailure* failure = nullptr) {
+        // ISO9660/UDF images are uncompressed and can be copied out without PeaZip
+        if (password.empty() && IsDiskImage(archivePath) && ExtractDiskImage(archivePath)) {
+            TraceSpan postSpan("post-process");
+            ReportExtractionSuccess(archivePath);
+            return true;
+        }
+        
+        // Multi-block .xz/.bz2/.gz streams and .zst files decode on every core
+        if (password.empty()) {
+            ExtractionFailure streamFailure = ExtractionFailure::None;
+            if (ExtractCompressedStream(archivePath, streamFailure)) {
+                TraceSpan postSpan("post-process");
+                ReportExtractionSuccess(archivePath);
+                return true;
+            }
+            if (StreamFailureIsFinal(streamFailure)) {
+                if (failure) *failure = streamFailure;
+                return false;
+            }
+        }
+        
+        // The engine has no notion of 2FA codes, so those still go through PeaZip
+        if (!sevenZipPath.empty() && twoFactorCode.empty()) {
+            return ExtractWithEngine(archivePath, password, failure);
+        }
+        
+        if (failure) *failure = ExtractionFailure::Unknown;
+        
         if (peazipPath.empty()) {
             ShowTrayNotification("Auto Unzip - Error", "PeaZip not found. Please install PeaZip.");
             LogEvent("PeaZip not found at expected locations");
+            if (failure) *failure = ExtractionFailure::EngineMissing;
             return false;
         }
         
-        // Create output directory
-        std::string outputDir = archivePath.substr(0, archivePath.find_last_of('.'));
-        
         // Build PeaZip command with enhanced options
         std::string command = "\"" + peazipPath + "\" -ext2folder -o+ ";
         
@@ -387,6 +3018,8 @@ public:
         si.dwFlags = STARTF_USESHOWWINDOW;
         si.wShowWindow = SW_HIDE;
         
+        auto start = std::chrono::steady_clock::now();
+        TraceSpan spawnSpan("spawn");
         BOOL success = CreateProcessA(
             NULL,
             const_cast<char*>(command.c_str()),
@@ -395,10 +3028,15 @@ public:
             NULL, NULL,
             &si, &pi
         );
+        DWORD spawnError = success ? 0 : GetLastError();
+        
+        spawnSpan.End();
         
         if (success) {
             // Wait with timeout
+            TraceSpan decompressSpan("decompress");
             DWORD waitResult = WaitForSingleObject(pi.hProcess, 300000); // 5 minutes timeout
+            decompressSpan.End();
             
             DWORD exitCode = 1;
             if (waitResult == WAIT_OBJECT_0) {
@@ -406,29 +3044,248 @@ public:
             } else if (waitResult == WAIT_TIMEOUT) {
                 TerminateProcess(pi.hProcess, 1);
                 LogEvent("Extraction timed out for: " + archivePath);
+                if (failure) *failure = ExtractionFailure::Timeout;
             }
             
             CloseHandle(pi.hProcess);
             CloseHandle(pi.hThread);
             
+            auto elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - start);
+            LogEvent("PeaZip finished in " + std::to_string(elapsed.count()) + " ms");
+            
             if (exitCode == 0) {
-                std::string filename = std::filesystem::path(archivePath).filename().string();
-                ShowTrayNotification("Auto Unzip - Success", ("Extracted: " + filename).c_str());
-                LogEvent("Successfully extracted: " + filename);
-                
-                // Reset password attempts on success
-                passwordAttempts.erase(filename);
+                TraceSpan postSpan("post-process");
+                ReportExtractionSuccess(archivePath);
                 return true;
             } else {
                 LogEvent("Extraction failed with exit code: " + std::to_string(exitCode));
             }
         } else {
-            LogEvent("Failed to start PeaZip process");
+            LogEvent("Failed to start PeaZip process (error " + std::to_string(spawnError) + ")");
+            if (failure) *failure = SpawnFailure(spawnError);
+        }
+        
+        return false;
+    }
+    
+    bool ExtractWithEngine(const std::string& archivePath, const std::string& password, ExtractionFailure* failure) {
+        // Same destination PeaZip's -ext2folder would use
+        std::string outputDir = archivePath.substr(0, archivePath.find_last_of('.'));
+        
+        LogEvent("Executing 7-Zip engine: \"" + sevenZipPath + "\" x \"" + archivePath + "\"");
+        SevenZipEngine::Result result = SevenZipEngine(sevenZipPath).Extract(archivePath, outputDir, password, 300000);
+        
+        LogEvent("7-Zip engine exit code " + std::to_string(result.exitCode) +
+                 ", first output after " + std::to_string(result.firstOutputNs / 1000000) + " ms" +
+                 ", finished in " + std::to_string(result.totalNs / 1000000) + " ms" +
+                 ", " + std::to_string(result.filesExtracted) + " items");
+        
+        if (failure) *failure = result.failure;
+        
+        if (result.failure == ExtractionFailure::None) {
+            if (result.exitCode == 1) {
+                LogEvent("7-Zip engine reported warnings for: " + archivePath);
+            }
+            
+            // 7z only removes the compression layer of a .tar.gz; unpack the .tar it left
+            if (IsCompressedTarball(archivePath) && result.filesExtracted == 1 &&
+                ArchiveNameFilter::EndsWithNoCase(result.lastItem, ".tar") &&
+                !UnpackInnerTarball(outputDir + "\\" + result.lastItem, outputDir, failure)) {
+                return false;
+            }
+            
+            TraceSpan postSpan("post-process");
+            ReportExtractionSuccess(archivePath);
+            return true;
+        }
+        
+        LogEvent(std::string("Extraction failed (") + FailureReasonName(result.failure) + ")" +
+                 (result.detail.empty() ? "" : ": " + result.detail));
+        return false;
+    }
+    
+    void ReportExtractionSuccess(const std::string& archivePath) {
+        std::string filename = std::filesystem::path(archivePath).filename().string();
+        ShowTrayNotification("Auto Unzip - Success", ("Extracted: " + filename).c_str());
+        LogEvent("Successfully extracted: " + filename);
+    }
+    
+    bool IsDiskImage(std::string_view filename) {
+        return ArchiveNameFilter::EndsWithNoCase(filename, ".iso") || ArchiveNameFilter::EndsWithNoCase(filename, ".img");
+    }
+    
+    bool ExtractDiskImage(const std::string& imagePath) {
+        DiskImageReader reader;
+        if (!reader.Open(imagePath) || !reader.Parse()) {
+            LogEvent("No ISO9660/UDF file system this reader can follow, using the archive engine for: " + imagePath);
+            return false;
+        }
+        
+        // Same destination PeaZip's -ext2folder would use
+        std::string outputDir = imagePath.substr(0, imagePath.find_last_of('.'));
+        
+        auto start = std::chrono::steady_clock::now();
+        std::string error;
+        TraceSpan writeSpan("write");
+        bool extracted = reader.ExtractTo(outputDir, error);
+        writeSpan.End();
+        
+        if (!extracted) {
+            LogEvent(std::string("Native ") + reader.FormatName() + " extraction failed (" + error + "), using PeaZip");
+            return false;
+        }
+        auto elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - start);
+        
+        LogEvent(std::string("Extracted ") + reader.FormatName() + " image natively: " +
+                 std::to_string(reader.Entries().size()) + " entries, " +
+                 std::to_string(reader.TotalFileBytes() / (1024 * 1024)) + " MB in " +
+                 std::to_string(elapsed.count()) + " ms");
+        return true;
+    }
+    
+    // Private bytes the service may still commit under [Performance] MemoryLimitMB; 0 once
+    // it is at the limit
+    uint64_t MemoryBudget() {
+        if (memoryLimitMB == 0) return UINT64_MAX;
+        
+        PROCESS_MEMORY_COUNTERS_EX counters = {};
+        counters.cb = sizeof(counters);
+        if (!K32GetProcessMemoryInfo(GetCurrentProcess(), (PROCESS_MEMORY_COUNTERS*)&counters, sizeof(counters))) {
+            return UINT64_MAX;
+        }
+        
+        uint64_t limit = (uint64_t)memoryLimitMB << 20;
+        if (counters.PrivateUsage >= limit) {
+            LogEvent("Memory limit reached (" + std::to_string(counters.PrivateUsage >> 20) +
+                     " MB in use), decoded chunks spill to disk");
+            return 0;
+        }
+        return limit - counters.PrivateUsage;
+    }
+    
+    // A hung decoder or a full disk would fail the single-stream path the same way, so these
+    // end the attempt instead of falling back
+    static bool StreamFailureIsFinal(ExtractionFailure failure) {
+        return failure == ExtractionFailure::Timeout || failure == ExtractionFailure::DiskFull;
+    }
+    
+    // Name of the file a single-file compressed stream expands to; .tgz-style names become .tar
+    std::string DecompressedName(const std::string& filename) {
+        for (const char* ext : {".tgz", ".tbz", ".tbz2", ".txz", ".tzst"}) {
+            if (ArchiveNameFilter::EndsWithNoCase(filename, ext)) {
+                return filename.substr(0, filename.size() - strlen(ext)) + ".tar";
+            }
+        }
+        
+        size_t dot = filename.find_last_of('.');
+        return dot == std::string::npos ? filename + ".out" : filename.substr(0, dot);
+    }
+    
+    bool ExtractCompressedStream(const std::string& archivePath, ExtractionFailure& failure) {
+        ParallelStreamDecoder decoder;
+        if (!decoder.Open(archivePath)) {
+            return false;
+        }
+        
+        ParallelStreamDecoder::Format format = decoder.StreamFormat();
+        std::string decoderCommand;
+        if (format == ParallelStreamDecoder::Format::Zstd) {
+            if (zstdPath.empty()) return false;
+            decoderCommand = "\"" + zstdPath + "\" -d -c -q";
+        } else {
+            if (sevenZipPath.empty()) return false;
+            decoderCommand = "\"" + sevenZipPath + "\" x -si -so -t" + ParallelStreamDecoder::FormatName(format);
+        }
+        
+        unsigned threads = decoderThreads ? decoderThreads : std::max(1u, std::thread::hardware_concurrency());
+        
+        // DecodeTo holds at most bufferBytes of out-of-order output in memory and spills the
+        // rest to disk, so a tight memory limit costs disk I/O rather than decoder threads
+        uint64_t bufferBytes = std::min<uint64_t>(MemoryBudget(), 256ull << 20);
+        
+        // One chunk at a time is just a slower single stream; only zstd has no other path
+        if (threads == 1 && format != ParallelStreamDecoder::Format::Zstd) {
+            return false;
+        }
+        
+        try {
+            if (!decoder.Plan(threads)) {
+                // A single block or member has nothing to parallelise; the engine handles it
+                return false;
+            }
+        } catch (const std::bad_alloc&) {
+            LogEvent("Not enough memory to plan a parallel decode, using the single-stream path: " + archivePath);
+            return false;
+        }
+        
+        // Same destination PeaZip's -ext2folder would use
+        std::string outputDir = archivePath.substr(0, archivePath.find_last_of('.'));
+        std::string innerName = DecompressedName(std::filesystem::path(archivePath).filename().string());
+        std::string outputPath = outputDir + "\\" + innerName;
+        bool isTarball = innerName.size() > 4 && _stricmp(innerName.c_str() + innerName.size() - 4, ".tar") == 0;
+        if (isTarball && sevenZipPath.empty()) {
+            return false;
+        }
+        
+        std::error_code ec;
+        std::filesystem::create_directories(outputDir, ec);
+        
+        auto start = std::chrono::steady_clock::now();
+        std::string error;
+        TraceSpan decompressSpan("decompress");
+        bool decoded = decoder.DecodeTo(outputPath, decoderCommand, threads, threads * 2, bufferBytes,
+                                        300000, failure, error);
+        decompressSpan.End();
+        auto elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - start);
+        
+        if (!decoded) {
+            LogEvent(std::string("Parallel ") + ParallelStreamDecoder::FormatName(format) +
+                     " decode failed (" + error + ")" +
+                     (StreamFailureIsFinal(failure) ? "" : ", using the single-stream path"));
+            return false;
+        }
+        
+        uint64_t outputBytes = std::filesystem::file_size(outputPath, ec);
+        LogEvent(std::string("Decoded ") + ParallelStreamDecoder::FormatName(format) + " stream in " +
+                 std::to_string(decoder.ChunkCount()) + " chunks on " + std::to_string(threads) + " threads: " +
+                 std::to_string(decoder.InputSize() / (1024 * 1024)) + " MB -> " +
+                 std::to_string(outputBytes / (1024 * 1024)) + " MB in " + std::to_string(elapsed.count()) + " ms");
+        
+        if (isTarball && !UnpackInnerTarball(outputPath, outputDir, &failure)) {
+            DeleteFileA(outputPath.c_str());
+            return false;
         }
         
+        return true;
+    }
+    
+    // .tar.gz, .tgz and friends: single-file compressed streams that wrap a tar
+    static bool IsCompressedTarball(std::string_view path) {
+        for (const char* ext : {".tgz", ".tbz", ".tbz2", ".txz", ".tzst", ".taz", ".tlz"}) {
+            if (ArchiveNameFilter::EndsWithNoCase(path, ext)) return true;
+        }
+        for (const char* ext : {".gz", ".bz2", ".xz", ".zst", ".lzma", ".z"}) {
+            if (ArchiveNameFilter::EndsWithNoCase(path, ext)) {
+                return ArchiveNameFilter::EndsWithNoCase(path.substr(0, path.size() - strlen(ext)), ".tar");
+            }
+        }
         return false;
     }
     
+    // Second pass for compressed tarballs: unpacks the intermediate .tar into the same
+    // folder and removes it, so the result matches what the PeaZip front-end produces
+    bool UnpackInnerTarball(const std::string& tarPath, const std::string& outputDir, ExtractionFailure* failure) {
+        TraceSpan writeSpan("write");
+        SevenZipEngine::Result result = SevenZipEngine(sevenZipPath).Extract(tarPath, outputDir, "", 300000);
+        if (result.failure != ExtractionFailure::None) {
+            LogEvent(std::string("Unpacking inner tarball failed (") + FailureReasonName(result.failure) + "): " + tarPath);
+            if (failure) *failure = result.failure;
+            return false;
+        }
+        DeleteFileA(tarPath.c_str());
+        return true;
+    }
+    
     void ShowTrayNotification(const char* title, const char* message) {
         nid.uFlags = NIF_INFO;
         lstrcpyA(nid.szInfoTitle, title);
@@ -438,14 +3295,7 @@ public:
         Shell_NotifyIcon(NIM_MODIFY, &nid);
     }
     
-    void LogEvent(const std::string& message) {
-        // Get current directory for log file
-        char currentDir[MAX_PATH];
-        GetModuleFileNameA(NULL, currentDir, MAX_PATH);
-        std::string currentDirStr(currentDir);
-        currentDirStr = currentDirStr.substr(0, currentDirStr.find_last_of("\\/"));
-        
-        std::string logPath = currentDirStr + "\\AutoUnzipService.log";
+    void LogEvent(std::string_view message) {
         std::ofstream logFile(logPath, std::ios::app);
         if (logFile.is_open()) {
             auto now = std::chrono::system_clock::now();
@@ -504,6 +3354,8 @@ public:
                         status += "Status: " + std::string(service->isPaused ? "Paused" : "Running") + "\n";
                         status += "Monitoring: " + service->downloadsPath + "\n";
                         status += "PeaZip Path: " + (service->peazipPath.empty() ? "Not Found" : service->peazipPath) + "\n";
+                        status += "7-Zip Engine: " + (service->sevenZipPath.empty() ? "Not Found" : service->sevenZipPath) + "\n";
+                        status += service->retryScheduler.Summary() + "\n";
                         
                         // Get log path
                         char currentDir[MAX_PATH];
@@ -603,6 +3455,13 @@ public:
     
     void Cleanup() {
         isRunning = false;
+        retryScheduler.Shutdown();
+        LogEvent(retryScheduler.Summary());
+        TraceRecorder::Instance().Shutdown();
+        if (memoryJob) {
+            CloseHandle(memoryJob);
+            memoryJob = NULL;
+        }
         Shell_NotifyIcon(NIM_DELETE, &nid);
         LogEvent("Auto Unzip Service stopped");
     }
@@ -687,7 +3546,8 @@ public:
     }
 };
 
-// Main entry point
+// Main entry point; tests that compile this file define AUTOUNZIP_NO_WINMAIN
+#ifndef AUTOUNZIP_NO_WINMAIN
 int WINAPI WinMain(HINSTANCE hInstance, HINSTANCE hPrevInstance, LPSTR lpCmdLine, int nCmdShow) {
     // Parse command line arguments
     if (strstr(lpCmdLine, "-install")) {
@@ -765,4 +3625,5 @@ int WINAPI WinMain(HINSTANCE hInstance, HINSTANCE hPrevInstance, LPSTR lpCmdLine
     }
     
     return 0;
-}
\ No newline at end of file
+}
+#endif
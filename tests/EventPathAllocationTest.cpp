@@ -0,0 +1,91 @@
+// Checks that the per-notification event path (name conversion and classification)
+// does not allocate once its buffers are warm. Every file that lands in Downloads goes
+// through this path, so it has to stay allocation-free for files that are not archives.
+
+#define AUTOUNZIP_NO_WINMAIN
+#include "../AutoUnzipService.cpp"
+
+#include <cstdio>
+#include <cstdlib>
+#include <new>
+
+static std::atomic<bool> countAllocations{false};
+static std::atomic<size_t> allocationCount{0};
+
+static void* CountedAllocate(size_t size) {
+    if (countAllocations) {
+        allocationCount++;
+    }
+    void* p = std::malloc(size ? size : 1);
+    if (!p) throw std::bad_alloc();
+    return p;
+}
+
+void* operator new(size_t size) { return CountedAllocate(size); }
+void* operator new[](size_t size) { return CountedAllocate(size); }
+void* operator new(size_t size, const std::nothrow_t&) noexcept { return std::malloc(size ? size : 1); }
+void* operator new[](size_t size, const std::nothrow_t&) noexcept { return std::malloc(size ? size : 1); }
+void operator delete(void* p) noexcept { std::free(p); }
+void operator delete[](void* p) noexcept { std::free(p); }
+void operator delete(void* p, size_t) noexcept { std::free(p); }
+void operator delete[](void* p, size_t) noexcept { std::free(p); }
+
+static int failures = 0;
+
+static void Expect(bool condition, const char* what) {
+    if (!condition) {
+        std::printf("FAILED: %s\n", what);
+        failures++;
+    }
+}
+
+int main() {
+    ArchiveNameFilter filter;
+
+    // Same classification the service relies on
+    Expect(filter.IsArchive("Backup.ZIP"), "upper-case .ZIP is an archive");
+    Expect(filter.IsArchive("movie.mkv.007"), "numbered split part is an archive");
+    Expect(filter.IsArchive("release.tar.zst"), ".zst is an archive");
+    Expect(!filter.IsArchive("report.pdf"), ".pdf is not an archive");
+    Expect(!filter.IsArchive("zip"), "bare extension text is not an archive");
+    Expect(filter.IsConventional("photos.7Z"), ".7Z is conventional");
+    Expect(!filter.IsConventional("image.iso"), ".iso is not conventional");
+
+    const wchar_t* names[] = {
+        L"report.pdf",
+        L"Quarterly Results FINAL (2).xlsx",
+        L"IMG_20240101_120000.JPG",
+        L"setup.exe",
+        L"movie.mkv.crdownload",
+        L"d\u00e9j\u00e0 vu \u65e5\u672c\u8a9e.docx",
+    };
+
+    // The service reserves this up front; conversions then reuse it
+    std::string eventName;
+    eventName.reserve(MAX_PATH * 4);
+
+    auto runEventPath = [&]() {
+        size_t archives = 0;
+        for (const wchar_t* name : names) {
+            ArchiveNameFilter::WStringToString(name, wcslen(name), eventName);
+            archives += filter.IsArchive(eventName);
+            archives += ArchiveNameFilter::EndsWithNoCase(eventName, ".zip");
+        }
+        return archives;
+    };
+
+    // Warm-up
+    Expect(runEventPath() == 0, "no test name is classified as an archive");
+
+    countAllocations = true;
+    for (int i = 0; i < 1000; i++) {
+        runEventPath();
+    }
+    countAllocations = false;
+
+    size_t allocations = allocationCount;
+    std::printf("Allocations on the steady-state event path: %zu\n", allocations);
+    Expect(allocations == 0, "steady-state event path performs no heap allocations");
+
+    return failures == 0 ? 0 : 1;
+}